@@ -0,0 +1,300 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Creating, listing and extracting the multi-file archives
+	described in huffarchive.h.
+*/
+
+#include "hufftree.h"
+#include <iterator>
+#include <set>
+#include "bitbuffer.h"
+#include "huffkernels.h"
+#include "huffformat.h"
+#include "huffarchive.h"
+#include "tablecache.h"
+#include "crc32c.h"
+
+using namespace std;
+
+// Everything before the members that a reader needs, plus the directory
+class ArchiveIndex
+{
+public:
+	int flags;
+	vector<unsigned char> sharedheader;		// bits of the shared tree header
+	vector<ArchiveEntry> entries;
+
+	ArchiveIndex()
+		: flags(0)
+	{
+	}
+};
+
+/* Reads a whole file into data */
+bool readWholeFile(const string &fileName, vector<unsigned char> &data)
+{
+	ifstream infile(fileName.c_str(), ios::binary);
+	if (!infile)
+		return false;
+	data.assign(istreambuf_iterator<char>(infile), istreambuf_iterator<char>());
+	return true;
+}
+
+/* File name without its directories; members are stored by name only */
+string memberName(const string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? path : path.substr(slash + 1);
+}
+
+/*	true if name is one memberName() can produce and is safe to append to a
+	directory: no separators, no "..", no drive prefix */
+bool validMemberName(const string &name)
+{
+	return !name.empty() && name != "." && name.size() <= 0xFFFF &&
+		name.find_first_of("/\\") == string::npos && name.find("..") == string::npos &&
+		!(name.size() >= 2 && name[1] == ':');
+}
+
+/* Loads the header and directory of an archive */
+bool readArchiveIndex(istream &in, ArchiveIndex &index)
+{
+	unsigned int magic, length;
+	if (!readU32(in, magic) || magic != HA_MAGIC)
+		return false;
+	int version = in.get();
+	index.flags = in.get();
+	if (version != HA_VERSION || index.flags == EOF || (index.flags & ~HA_SHARED_TABLE))
+		return false;
+	if (index.flags & HA_SHARED_TABLE)
+	{
+		if (!readU32(in, length) || length == 0)
+			return false;
+		index.sharedheader.resize(length);
+		if (!in.read((char*)&index.sharedheader[0], length))
+			return false;
+	}
+
+	// the trailer says where the directory is
+	unsigned long long directory;
+	in.seekg(0, ios::end);
+	const unsigned long long archivesize = (unsigned long long)in.tellg();
+	in.seekg(-HA_TRAILER_SIZE, ios::end);
+	if (!readU64(in, directory) || !readU32(in, magic) || magic != HA_MAGIC)
+		return false;
+	if (directory > archivesize)
+		return false;
+	in.seekg(streamoff(directory));
+
+	unsigned int count;
+	if (!readU32(in, count))
+		return false;
+	index.entries.clear();
+	for (unsigned int i = 0; i < count; i++)
+	{
+		ArchiveEntry entry;
+		int high = in.get(), low = in.get();
+		if (low == EOF)
+			return false;
+		entry.name.resize((high << 8) | low);
+		if (!entry.name.empty() && !in.read(&entry.name[0], entry.name.size()))
+			return false;
+		if (!readU64(in, entry.offset) || !readU64(in, entry.size) ||
+			!readU64(in, entry.length) || !readU32(in, entry.crc))
+			return false;
+
+		// members lie before the directory, and every code takes at least a bit except an
+		// empty member's lone PSEUDO_EOF under a shared table. A member is decoded whole, so
+		// it can't be longer than a block
+		if (!validMemberName(entry.name) || (entry.size == 0 && entry.length != 0) || entry.offset > directory ||
+			entry.size > directory - entry.offset || entry.length / 8 > entry.size ||
+			entry.length > (unsigned long long)HF_MAX_BLOCK_SIZE)
+			return false;
+		index.entries.push_back(entry);
+	}
+	return true;
+}
+
+/*	Packs srcFiles into one archive. With sharedTable, one tree built from all
+	of the files codes every member, which saves a header per member at the
+	cost of reading every file twice. */
+bool HuffTree::archive(const vector<string> &srcFileNames, const string &destFileName, bool sharedTable)
+{
+	// members are found by name, so two paths ending in the same name can't both go in
+	set<string> names;
+	for (size_t f = 0; f < srcFileNames.size(); f++)
+		if (!validMemberName(memberName(srcFileNames[f])) || !names.insert(memberName(srcFileNames[f])).second)
+			return false;
+
+	vector<unsigned char> data;
+	CodeTablePtr shared;
+	if (sharedTable)
+	{
+		vector<int> counts(SymbolTraits<unsigned short>::ALPHABET, 0);
+		for (size_t f = 0; f < srcFileNames.size(); f++)
+		{
+			if (!readWholeFile(srcFileNames[f], data))
+				return false;
+			for (size_t i = 0; i < data.size(); i++)
+				counts[data[i]]++;
+		}
+		shared = exactTable(counts);
+	}
+
+	ofstream outfile(destFileName.c_str(), ios::binary);
+	writeU32(outfile, HA_MAGIC);
+	outfile.put(char(HA_VERSION));
+	outfile.put(char(sharedTable ? HA_SHARED_TABLE : 0));
+	if (shared)
+	{
+		BitWriter header;
+		shared->tree->writeFileHeader(header);
+		header.flushbits();
+		writeU32(outfile, unsigned(header.bytes().size()));
+		outfile.write((const char*)&header.bytes()[0], header.bytes().size());
+	}
+
+	vector<ArchiveEntry> entries;
+	vector<unsigned short> symbols;
+	for (size_t f = 0; f < srcFileNames.size(); f++)
+	{
+		if (!readWholeFile(srcFileNames[f], data) || data.size() > size_t(HF_MAX_BLOCK_SIZE))
+			return false;
+		symbols.assign(data.begin(), data.end());
+
+		CodeTablePtr table = shared;
+		BitWriter bits;
+		if (!table)
+		{
+			vector<int> counts(SymbolTraits<unsigned short>::ALPHABET, 0);
+			for (size_t i = 0; i < data.size(); i++)
+				counts[data[i]]++;
+			table = exactTable(counts);
+			table->tree->writeFileHeader(bits);
+		}
+		writeCodes(*table, symbols.empty() ? NULL : &symbols[0], symbols.size(), bits);
+		bits.flushbits();
+
+		ArchiveEntry entry;
+		entry.name = memberName(srcFileNames[f]);
+		entry.offset = (unsigned long long)outfile.tellp();
+		entry.size = bits.bytes().size();
+		entry.length = data.size();
+		entry.crc = crc32c(0, data.empty() ? NULL : &data[0], data.size());
+		entries.push_back(entry);
+
+		outfile.write((const char*)&bits.bytes()[0], bits.bytes().size());
+	}
+
+	unsigned long long directory = (unsigned long long)outfile.tellp();
+	writeU32(outfile, unsigned(entries.size()));
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const ArchiveEntry &entry = entries[i];
+		size_t namelength = min<size_t>(entry.name.size(), 0xFFFF);
+		outfile.put(char(namelength >> 8));
+		outfile.put(char(namelength));
+		outfile.write(entry.name.data(), namelength);
+		writeU64(outfile, entry.offset);
+		writeU64(outfile, entry.size);
+		writeU64(outfile, entry.length);
+		writeU32(outfile, entry.crc);
+	}
+	writeU64(outfile, directory);
+	writeU32(outfile, HA_MAGIC);
+
+	return bool(outfile);
+}
+
+/* Reads the directory of an archive */
+bool HuffTree::listArchive(const string &archiveName, vector<ArchiveEntry> &entries)
+{
+	ifstream infile(archiveName.c_str(), ios::binary);
+	ArchiveIndex index;
+	if (!readArchiveIndex(infile, index))
+		return false;
+	entries.swap(index.entries);
+	return true;
+}
+
+/* Decodes one member, checking its length and checksum, into destFile */
+bool HuffTree::extractMember(istream &infile, const shared_ptr<const CodeTable> &shared,
+	const ArchiveEntry &entry, const string &destFileName)
+{
+	vector<unsigned char> payload(size_t(entry.size));
+	infile.clear();
+	infile.seekg(streamoff(entry.offset));
+	if (!payload.empty() && !infile.read((char*)&payload[0], payload.size()))
+		return false;
+
+	// a member with no bytes is empty, and readArchiveIndex has checked its length says so
+	vector<unsigned short> symbols;
+	if (!payload.empty())
+	{
+		BitReader bits(&payload[0], payload.size());
+		CodeTablePtr table = shared ? shared : tableFromHeader(bits);
+		if (!table || !readCodes(*table, bits, size_t(entry.length), symbols))
+			return false;
+	}
+
+	vector<unsigned char> data(symbols.begin(), symbols.end());
+	if (crc32c(0, data.empty() ? NULL : &data[0], data.size()) != entry.crc)
+		return false;
+
+	ofstream outfile(destFileName.c_str(), ios::binary);
+	if (!data.empty())
+		outfile.write((const char*)&data[0], data.size());
+	return bool(outfile);
+}
+
+/* Extracts the member called memberName into destFile */
+bool HuffTree::extract(const string &archiveName, const string &memberName, const string &destFileName)
+{
+	vector<string> names(1, memberName), destFileNames(1, destFileName);
+	return extract(archiveName, names, destFileNames);
+}
+
+/*	Extracts several members with one open of the archive. destFileNames[i]
+	receives memberNames[i]; all members are extracted when memberNames is
+	empty, each to destFileNames[0] + its own name. */
+bool HuffTree::extract(const string &archiveName, const vector<string> &memberNames, const vector<string> &destFileNames)
+{
+	ifstream infile(archiveName.c_str(), ios::binary);
+	ArchiveIndex index;
+	if (!readArchiveIndex(infile, index))
+		return false;
+
+	CodeTablePtr shared;
+	if (index.flags & HA_SHARED_TABLE)
+	{
+		BitReader header(&index.sharedheader[0], index.sharedheader.size());
+		shared = tableFromHeader(header);
+		if (!shared)
+			return false;
+	}
+
+	bool ok = true;
+	if (memberNames.empty())
+	{
+		string prefix = destFileNames.empty() ? string() : destFileNames[0];
+		for (size_t i = 0; i < index.entries.size(); i++)
+			ok = extractMember(infile, shared, index.entries[i], prefix + index.entries[i].name) && ok;
+		return ok;
+	}
+
+	for (size_t m = 0; m < memberNames.size(); m++)
+	{
+		size_t i = 0;
+		while (i < index.entries.size() && index.entries[i].name != memberNames[m])
+			i++;
+		if (i == index.entries.size())
+		{
+			ok = false;
+			continue;
+		}
+		const string &dest = m < destFileNames.size() && !destFileNames[m].empty() ? destFileNames[m] : memberNames[m];
+		ok = extractMember(infile, shared, index.entries[i], dest) && ok;
+	}
+	return ok;
+}
@@ -0,0 +1,625 @@
+/*
+	Created on 10/19/2026
+
+	Summary: The block-structured .hf format described in huffformat.h. Input
+	is cut into blocks, each block goes through the optional transforms and is
+	then Huffman coded with a tree built from its own symbols.
+*/
+
+#include "hufftree.h"
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <sstream>
+#include "bitops.h"
+#include "bitbuffer.h"
+#include "boundedqueue.h"
+#include "huffkernels.h"
+#include "huffformat.h"
+#include "blocksort.h"
+#include "lz77.h"
+#include "filters.h"
+#include "crc32c.h"
+#include "tablecache.h"
+
+using namespace std;
+
+/* Writes a 32-bit value, most significant byte first */
+void writeU32(ostream &out, unsigned int value)
+{
+	char bytes[4] = { char(value >> 24), char(value >> 16), char(value >> 8), char(value) };
+	out.write(bytes, 4);
+}
+
+/* Reads a 32-bit value written by writeU32 */
+bool readU32(istream &in, unsigned int &value)
+{
+	unsigned char bytes[4];
+	if (!in.read((char*)bytes, 4))
+		return false;
+	value = (unsigned(bytes[0]) << 24) | (unsigned(bytes[1]) << 16) | (unsigned(bytes[2]) << 8) | bytes[3];
+	return true;
+}
+
+void writeU64(ostream &out, unsigned long long value)
+{
+	writeU32(out, (unsigned int)(value >> 32));
+	writeU32(out, (unsigned int)value);
+}
+
+bool readU64(istream &in, unsigned long long &value)
+{
+	unsigned int high, low;
+	if (!readU32(in, high) || !readU32(in, low))
+		return false;
+	value = ((unsigned long long)high << 32) | low;
+	return true;
+}
+
+void writeFormatHeader(ostream &out, const HuffFileInfo &info)
+{
+	writeU32(out, HF_MAGIC);
+	out.put(char(HF_VERSION));
+	out.put(char(info.flags));
+	writeU32(out, info.blocksize);
+	if (info.flags & HF_FILTER)
+	{
+		out.put(char(info.filters));
+		out.put(char(info.filterwidth));
+	}
+	if (info.flags & HF_LENGTHS)
+		writeU64(out, info.length);
+	if (info.flags & HF_LZ77)
+		out.put(char(info.lzlevel));
+}
+
+bool readFormatHeader(istream &in, HuffFileInfo &info)
+{
+	unsigned int magic;
+	if (!readU32(in, magic) || magic != HF_MAGIC)
+		return false;
+
+	int version = in.get();
+	info.flags = in.get();
+	if (version != HF_VERSION || info.flags == EOF || (info.flags & ~HF_ALL_FLAGS))
+		return false;
+	if (!readU32(in, info.blocksize) || info.blocksize == 0 || info.blocksize > (unsigned)HF_MAX_BLOCK_SIZE)
+		return false;
+
+	info.filters = 0;
+	info.filterwidth = 0;
+	if (info.flags & HF_FILTER)
+	{
+		info.filters = in.get();
+		info.filterwidth = in.get();
+		if (info.filters == EOF || (info.filters & ~FILTER_ALL) || !validFilterWidth(info.filterwidth))
+			return false;
+	}
+
+	info.length = 0;
+	if ((info.flags & HF_LENGTHS) && !readU64(in, info.length))
+		return false;
+
+	info.lzlevel = 0;
+	if (info.flags & HF_LZ77)
+	{
+		info.lzlevel = in.get();
+		if (info.lzlevel == EOF || (info.flags & HF_BLOCKSORT))
+			return false;
+	}
+	return true;
+}
+
+void writeBlockRecord(ostream &out, const HuffFileInfo &info, const BlockRecord &record)
+{
+	writeU32(out, unsigned(record.payload.size()));
+	if (info.flags & (HF_CHECKSUM | HF_LENGTHS))
+		writeU32(out, record.rawlength);
+	if (info.flags & HF_CHECKSUM)
+	{
+		writeU32(out, record.payloadcrc);
+		writeU32(out, record.datacrc);
+	}
+	if (info.flags & HF_LENGTHS)
+		writeU32(out, record.symbols);
+	if (info.flags & HF_TABLEREF)
+		writeU32(out, record.tableref);
+	out.write((const char*)&record.payload[0], record.payload.size());
+}
+
+void writeEndRecord(ostream &out)
+{
+	writeU32(out, 0);
+}
+
+RecordStatus readBlockRecord(istream &in, const HuffFileInfo &info, BlockRecord &record)
+{
+	unsigned int length;
+	if (!readU32(in, length))
+		return RECORD_BAD;	// missing end of file marker
+	if (length == 0)
+		return RECORD_END;
+
+	if ((info.flags & (HF_CHECKSUM | HF_LENGTHS)) && !readU32(in, record.rawlength))
+		return RECORD_BAD;
+	if ((info.flags & HF_CHECKSUM) && (!readU32(in, record.payloadcrc) || !readU32(in, record.datacrc)))
+		return RECORD_BAD;
+	if ((info.flags & HF_LENGTHS) && !readU32(in, record.symbols))
+		return RECORD_BAD;
+	record.tableref = HF_INLINE_TABLE;
+	if ((info.flags & HF_TABLEREF) && !readU32(in, record.tableref))
+		return RECORD_BAD;
+
+	// a damaged length mustn't size the buffer: it can't exceed what the block size codes to,
+	// or what is left of the stream when that can be told
+	if (length > (unsigned long long)HF_PAYLOAD_PER_BYTE * info.blocksize + HF_PAYLOAD_OVERHEAD)
+		return RECORD_BAD;
+	istream::pos_type here = in.tellg();
+	if (here != istream::pos_type(-1))
+	{
+		in.seekg(0, ios::end);
+		istream::pos_type end = in.tellg();
+		in.seekg(here);
+		if (end != istream::pos_type(-1) && length > (unsigned long long)(end - here))
+			return RECORD_BAD;
+	}
+
+	record.payload.resize(length);
+	if (!in.read((char*)&record.payload[0], length))
+		return RECORD_BAD;
+	return RECORD_OK;
+}
+
+/* Checks for the block format's magic number */
+bool HuffTree::isBlockFile(const string &fileName)
+{
+	ifstream infile(fileName.c_str(), ios::binary);
+	unsigned int magic;
+	return readU32(infile, magic) && magic == HF_MAGIC;
+}
+
+/*	Runs block number index through the transforms in info and codes it. With
+	HF_TABLEREF, the tree comes from the shared cache and is only stored if no
+	block in window already stored it. */
+void HuffTree::encodeBlock(const HuffFileInfo &info, const unsigned char *data, int n, unsigned int index, TableWindow &window, BlockRecord &record)
+{
+	vector<unsigned char> filtered, sorted;
+	vector<unsigned short> symbols, distances;
+	BitWriter extras;
+
+	const unsigned char *block = data;
+	if (info.flags & HF_FILTER)
+	{
+		filtered.resize(n);
+		applyFilters(info.filters, info.filterwidth, data, n, &filtered[0]);
+		block = &filtered[0];
+	}
+
+	BitWriter bits;
+	if (info.flags & HF_BLOCKSORT)
+	{
+		sorted.resize(n);
+		int primary = bwtForward(block, n, &sorted[0]);
+		bits.writebits(32, primary);
+		mtfRleEncode(&sorted[0], n, symbols);
+	}
+	else if (info.flags & HF_LZ77)
+		lzEncode(block, n, info.lzlevel, symbols, distances, extras);
+	else
+		symbols.assign(block, block + n);
+
+	vector<int> counts(SymbolTraits<unsigned short>::ALPHABET, 0);
+	for (size_t i = 0; i < symbols.size(); i++)
+		counts[symbols[i]]++;
+
+	CodeTablePtr table;
+	record.tableref = HF_INLINE_TABLE;
+	if (info.flags & HF_TABLEREF)
+	{
+		string key;
+		table = tableForCounts(counts, key);
+		if (!window.find(key, record.tableref, table))
+			window.add(index, key, table);
+	}
+	else
+		table = exactTable(counts);
+
+	if (record.tableref == HF_INLINE_TABLE)
+		table->tree->writeFileHeader(bits);
+	if (info.flags & HF_LZ77)
+	{
+		vector<int> distancecounts(SymbolTraits<unsigned short>::ALPHABET, 0);
+		for (size_t i = 0; i < distances.size(); i++)
+			distancecounts[distances[i]]++;
+		CodeTablePtr distancetable = exactTable(distancecounts);
+		distancetable->tree->writeFileHeader(bits);
+
+		writeCodes(*table, symbols.empty() ? NULL : &symbols[0], symbols.size(), bits);
+		writeCodes(*distancetable, distances.empty() ? NULL : &distances[0], distances.size(), bits);
+		bits.flushbits();
+		extras.flushbits();
+		bits.bytes().insert(bits.bytes().end(), extras.bytes().begin(), extras.bytes().end());
+	}
+	else
+	{
+		writeCodes(*table, symbols.empty() ? NULL : &symbols[0], symbols.size(), bits);
+		bits.flushbits();
+	}
+
+	record.payload.swap(bits.bytes());
+	record.rawlength = n;
+	record.symbols = unsigned(symbols.size());
+	if (info.flags & HF_CHECKSUM)
+	{
+		record.payloadcrc = crc32c(0, &record.payload[0], record.payload.size());
+		record.datacrc = crc32c(0, data, n);
+	}
+}
+
+/*	Reads the tree a block stores, without decoding the block. NULL if the
+	block refers to another block's tree or its header is damaged. */
+CodeTablePtr HuffTree::blockTable(const HuffFileInfo &info, const BlockRecord &record)
+{
+	if (record.tableref != HF_INLINE_TABLE)
+		return CodeTablePtr();
+
+	BitReader bits(&record.payload[0], record.payload.size());
+	int primary;
+	if ((info.flags & HF_BLOCKSORT) && !bits.readbits(32, primary))
+		return CodeTablePtr();
+	return tableFromHeader(bits);
+}
+
+/*	Decodes one block and undoes its transforms. table must hold the tree of
+	the block a referring block names; for a block with its own tree it is set
+	to that tree. False if the block is damaged: a checksum or length
+	mismatch, or codes that don't decode. With HF_LENGTHS, every buffer is
+	sized before decoding starts and the codes are decoded by count. */
+bool HuffTree::decodeBlock(const HuffFileInfo &info, const BlockRecord &record, CodeTablePtr &table, vector<unsigned char> &data)
+{
+	const bool checked = (info.flags & HF_CHECKSUM) != 0;
+	const bool counted = (info.flags & HF_LENGTHS) != 0;
+	if (checked && crc32c(0, &record.payload[0], record.payload.size()) != record.payloadcrc)
+		return false;
+	if (counted && (record.rawlength > info.blocksize || record.symbols > info.blocksize))
+		return false;
+
+	vector<unsigned char> sorted, filtered;
+	vector<unsigned short> symbols;
+	if (counted)
+	{
+		sorted.reserve(record.rawlength);
+		data.reserve(record.rawlength);
+	}
+
+	BitReader bits(&record.payload[0], record.payload.size());
+	int primary = 0;
+	if ((info.flags & HF_BLOCKSORT) && !bits.readbits(32, primary))
+		return false;
+	if (record.tableref == HF_INLINE_TABLE)
+		table = tableFromHeader(bits);
+	if (!table)
+		return false;
+
+	CodeTablePtr distancetable;
+	if ((info.flags & HF_LZ77) && !(distancetable = tableFromHeader(bits)))
+		return false;
+	if (counted ? !readCodes(*table, bits, record.symbols, symbols) : !readCodes(*table, bits, symbols))
+		return false;
+
+	if (info.flags & HF_LZ77)
+	{
+		// a counted decode stops short of PSEUDO_EOF, and more codes follow it
+		if (counted && !readEOF(*table, bits))
+			return false;
+		vector<unsigned short> distances;
+		if (counted)
+		{
+			size_t matches = lzMatchCount(symbols.empty() ? NULL : &symbols[0], symbols.size());
+			if (!readCodes(*distancetable, bits, matches, distances) || !readEOF(*distancetable, bits))
+				return false;
+		}
+		else if (!readCodes(*distancetable, bits, distances))
+			return false;
+		bits.alignToByte();
+		if (!lzDecode(symbols.empty() ? NULL : &symbols[0], symbols.size(), distances.empty() ? NULL : &distances[0], 
+				distances.size(), bits, int(info.blocksize), data))
+			return false;
+	}
+	else if (info.flags & HF_BLOCKSORT)
+	{
+		data.clear();
+		if (!symbols.empty())
+		{
+			if (!mtfRleDecode(&symbols[0], symbols.size(), int(info.blocksize), sorted))
+				return false;
+			data.resize(sorted.size());
+			if (!bwtInverse(&sorted[0], int(sorted.size()), primary, &data[0]))
+				return false;
+		}
+	}
+	else
+	{
+		if (symbols.size() > info.blocksize)
+			return false;
+		data.assign(symbols.begin(), symbols.end());
+	}
+
+	if ((info.flags & HF_FILTER) && !data.empty())
+	{
+		filtered.resize(data.size());
+		removeFilters(info.filters, info.filterwidth, &data[0], data.size(), &filtered[0]);
+		data.swap(filtered);
+	}
+
+	if ((checked || counted) && data.size() != record.rawlength)
+		return false;
+	if (checked && crc32c(0, data.empty() ? NULL : &data[0], data.size()) != record.datacrc)
+		return false;
+	return true;
+}
+
+/* true if options describe a block format file this version can write */
+bool validBlockOptions(const HuffOptions &options)
+{
+	if (options.blocksize <= 0 || options.blocksize > HF_MAX_BLOCK_SIZE)
+		return false;
+	if (options.filters && !validFilterWidth(options.filterwidth))
+		return false;
+	if (options.lzlevel && (options.blocksort || options.lzlevel < LZ_MIN_LEVEL || options.lzlevel > LZ_MAX_LEVEL))
+		return false;
+	return true;
+}
+
+/* Compresses srcFile into destFile one block at a time */
+bool HuffTree::huffBlocks(const string &srcFileName, const string &destFileName, const HuffOptions &options)
+{
+	ifstream infile(srcFileName.c_str(), ios::binary);
+	if (!infile || !validBlockOptions(options))
+		return false;
+	ofstream outfile(destFileName.c_str(), ios::binary);
+	return huffBlocks(infile, outfile, options);
+}
+
+/* Compresses all of infile, which must be seekable, into outfile */
+bool HuffTree::huffBlocks(istream &infile, ostream &outfile, const HuffOptions &options)
+{
+	if (!validBlockOptions(options))
+		return false;
+
+	HuffFileInfo info(options);
+	if (info.flags & HF_LENGTHS)
+	{
+		infile.seekg(0, ios::end);
+		info.length = (unsigned long long)infile.tellg();
+		infile.seekg(0, ios::beg);
+	}
+	writeFormatHeader(outfile, info);
+
+	vector<unsigned char> block(options.blocksize);
+	BlockRecord record;
+	TableWindow window(HF_TABLE_WINDOW);
+	for (unsigned int index = 0; ; index++)
+	{
+		infile.read((char*)&block[0], block.size());
+		int n = int(infile.gcount());
+		if (n == 0)
+			break;
+
+		encodeBlock(info, &block[0], n, index, window, record);
+		writeBlockRecord(outfile, info, record);
+	}
+	writeEndRecord(outfile);
+
+	return bool(outfile);
+}
+
+/*	Uncompresses a block format srcFile into destFile. With checksums, a
+	damaged block is replaced by zeros of its original length and the rest
+	of the file is still recovered; false is returned at the end. With
+	HF_LENGTHS, destFile is extended to its final size before any block is
+	written, and a file that comes up short is reported. */
+bool HuffTree::unhuffBlocks(const string &srcFileName, const string &destFileName)
+{
+	ifstream infile(srcFileName.c_str(), ios::binary);
+	HuffFileInfo info;
+	if (!readFormatHeader(infile, info))
+		return false;
+
+	ofstream outfile(destFileName.c_str(), ios::binary);
+	if ((info.flags & HF_LENGTHS) && info.length > 0)
+	{	// let the file system allocate the whole output at once
+		outfile.seekp(streamoff(info.length - 1));
+		outfile.put(0);
+		outfile.seekp(0);
+	}
+
+	infile.seekg(0);
+	return unhuffBlocks(infile, outfile);
+}
+
+/* Uncompresses a block format infile into outfile, as unhuffBlocks above */
+bool HuffTree::unhuffBlocks(istream &infile, ostream &outfile)
+{
+	HuffFileInfo info;
+	if (!readFormatHeader(infile, info))
+		return false;
+
+	BlockRecord record;
+	vector<unsigned char> block;
+	TableWindow window(HF_TABLE_WINDOW);
+	unsigned long long written = 0;
+	bool intact = true;
+	RecordStatus status;
+	for (unsigned int index = 0; (status = readBlockRecord(infile, info, record)) == RECORD_OK; index++)
+	{
+		CodeTablePtr table;
+		if (record.tableref != HF_INLINE_TABLE)
+			table = window.table(record.tableref);
+
+		bool good = decodeBlock(info, record, table, block);
+		if (record.tableref == HF_INLINE_TABLE)
+			window.add(index, string(), table);
+		if (!good)
+		{
+			if (!(info.flags & (HF_CHECKSUM | HF_LENGTHS)) || record.rawlength > info.blocksize)
+				return false;
+
+			// keep the blocks after this one at their right offsets
+			intact = false;
+			block.assign(record.rawlength, 0);
+		}
+
+		if (!block.empty())
+			outfile.write((const char*)&block[0], block.size());
+		written += block.size();
+	}
+
+	if ((info.flags & HF_LENGTHS) && written != info.length)
+		return false;
+	return intact && status == RECORD_END;
+}
+
+/*	Compresses src into dest. The result is always in the block format, since
+	the original format's header can't be written before the whole input has
+	been counted. */
+bool HuffTree::huff(const vector<unsigned char> &src, vector<unsigned char> &dest, const HuffOptions &options)
+{
+	istringstream infile(string(src.begin(), src.end()));
+	ostringstream outfile;
+	if (!huffBlocks(infile, outfile, options))
+		return false;
+	const string &bytes = outfile.str();
+	dest.assign(bytes.begin(), bytes.end());
+	return true;
+}
+
+/* Uncompresses src, in either format, into dest */
+bool HuffTree::unhuff(const vector<unsigned char> &src, vector<unsigned char> &dest)
+{
+	if (src.size() >= 4 && ((unsigned(src[0]) << 24) | (unsigned(src[1]) << 16) | (unsigned(src[2]) << 8) | src[3]) == HF_MAGIC)
+	{
+		istringstream infile(string(src.begin(), src.end()));
+		ostringstream outfile;
+		if (!unhuffBlocks(infile, outfile))
+			return false;
+		const string &bytes = outfile.str();
+		dest.assign(bytes.begin(), bytes.end());
+		return true;
+	}
+
+	if (src.empty())
+		return false;
+	BitReader bits(&src[0], src.size());
+	CodeTablePtr table = tableFromHeader(bits);
+	vector<unsigned short> symbols;
+	if (!table || !readCodes(*table, bits, symbols))
+		return false;
+
+	// original-format leaves for bytes >= 128 are negative; the low 8 bits are the byte
+	dest.resize(symbols.size());
+	for (size_t i = 0; i < symbols.size(); i++)
+		dest[i] = (unsigned char)symbols[i];
+	return true;
+}
+
+/*	Checks every block of a file, several blocks at a time. Blocks with
+	checksums are checked against them; deep also decodes every block. Files
+	without checksums, including original-format ones, are always decoded. */
+bool HuffTree::verify(const string &fileName, bool deep, VerifyReport &report)
+{
+	report = VerifyReport();
+
+	if (!isBlockFile(fileName))
+	{	// one stream, all we can do is decode it
+		ibstream infile(fileName);
+		HuffPtr hufftree = treeFromHeader(infile);
+		report.blocks = 1;
+		ostream nowhere(NULL);
+		if (hufftree == NULL || !hufftree->decompressFile(infile, nowhere))
+			report.badblocks.push_back(0);
+		delete hufftree;
+		return report.ok();
+	}
+
+	ifstream infile(fileName.c_str(), ios::binary);
+	HuffFileInfo info;
+	if (!readFormatHeader(infile, info))
+	{
+		report.intact = false;
+		return false;
+	}
+	report.checksummed = (info.flags & HF_CHECKSUM) != 0;
+	if (!report.checksummed)
+		deep = true;
+
+	// the reader hands numbered records to a pool of checkers
+	class Job
+	{
+	public:
+		int index;
+		BlockRecord *record;
+		CodeTablePtr table;		// tree of the block record refers to
+	};
+	int workers = max(1u, thread::hardware_concurrency());
+	BoundedQueue<Job> jobs(2 * workers);
+	mutex lock;
+
+	vector<thread> pool;
+	for (int i = 0; i < workers; i++)
+		pool.push_back(thread([&]()
+		{
+			Job job;
+			vector<unsigned char> block;
+			while (jobs.pop(job))
+			{
+				const BlockRecord &record = *job.record;
+				bool good;
+				if (deep)
+					good = decodeBlock(info, record, job.table, block);
+				else
+					good = crc32c(0, &record.payload[0], record.payload.size()) == record.payloadcrc;
+				delete job.record;
+
+				if (!good)
+				{
+					lock_guard<mutex> guard(lock);
+					report.badblocks.push_back(job.index);
+				}
+			}
+		}));
+
+	// trees shared between blocks are read here, in order, before the blocks go out
+	TableWindow window(HF_TABLE_WINDOW);
+	unsigned long long total = 0;
+	RecordStatus status;
+	for (;;)
+	{
+		Job job;
+		job.record = new BlockRecord;
+		status = readBlockRecord(infile, info, *job.record);
+		if (status != RECORD_OK)
+		{
+			delete job.record;
+			break;
+		}
+
+		job.index = report.blocks++;
+		total += job.record->rawlength;
+		if (deep && (info.flags & HF_TABLEREF))
+		{
+			if (job.record->tableref == HF_INLINE_TABLE)
+				window.add(job.index, string(), blockTable(info, *job.record));
+			else
+				job.table = window.table(job.record->tableref);
+		}
+		jobs.push(job);
+	}
+	jobs.close();
+	for (size_t i = 0; i < pool.size(); i++)
+		pool[i].join();
+
+	report.intact = status == RECORD_END && (!(info.flags & HF_LENGTHS) || total == info.length);
+	sort(report.badblocks.begin(), report.badblocks.end());
+	return report.ok();
+}
@@ -0,0 +1,477 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Multi-threaded coding of original-format .hf files, which are a
+	single stream of codes with no block boundaries to split at.
+
+	Encoding counts and codes the input in rounds of one slice per thread.
+	The slices' byte counts are merged into one histogram, so the tree is
+	the one huff would build. Each slice is then coded into its own bit
+	buffer; a prefix sum of their bit lengths gives every slice its offset
+	in the round's output, each thread shifts its bits to that offset, and
+	the shifted slices are joined into one stream that decompressFile reads
+	like any other.
+
+	For decoding, the stream is cut into slices at arbitrary bit offsets and every slice is
+	decoded at once on its own thread, starting from a guess that its first
+	bit begins a code. The guess is usually wrong, but Huffman codes are
+	self-synchronizing: a decoder that starts mid-code falls back into step
+	with the true code boundaries within a few symbols. Each slice records
+	where its first symbols started, and the slice before it keeps decoding
+	past its own end until it reaches one of those positions. From that
+	point on the speculative slice's output is known to be right.
+
+	Slices are decoded in rounds of one slice per thread. Only the round's
+	window of the file, plus a margin for the last slice's final code, and
+	the round's output are held in memory. If a slice never synchronizes within the
+	positions it recorded, the next round simply starts at the last known
+	code boundary.
+*/
+
+#include "hufftree.h"
+#include <thread>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include "bitbuffer.h"
+#include "huffkernels.h"
+#include "globals.h"
+#include "bytecounts.h"
+
+using namespace std;
+
+// Intermediate functions for building the Huffman Tree
+Histogram* countsHistogram(const long long counts[256]);
+
+// compressed bytes handed to each thread per round
+const unsigned long long SLICE_BYTES = 1 << 20;
+
+// input bytes handed to each thread per round when encoding
+const size_t ENCODE_SLICE_BYTES = 1 << 22;
+
+// enough of the file for the largest tree header (1023 nodes of at most 10 bits)
+const size_t HEADER_BYTES = 2048;
+
+// code boundaries recorded at the start of each slice, to synchronize against
+const size_t SYNC_SYMBOLS = 4096;
+
+const size_t NO_SYNC = size_t(-1);
+
+// One speculatively decoded piece of the code stream
+class Slice
+{
+public:
+	unsigned long long start;		// first bit, taken to begin a code
+	unsigned long long limit;		// start of the next slice
+	unsigned long long end;			// first code boundary at or past limit
+	vector<unsigned long long> starts;	// where the first SYNC_SYMBOLS codes began
+	vector<unsigned char> out;		// out[i] is the symbol that began at starts[i]
+	DecodeStatus status;			// DECODE_FULL if the slice reached limit
+
+	// filled in from the following slice
+	vector<unsigned char> overflow;	// symbols from end up to the sync point
+	size_t sync;					// index into the next slice's starts, or NO_SYNC
+	unsigned long long stop;		// where the overflow stopped
+	DecodeStatus overflowstatus;
+
+	Slice()
+		: start(0), limit(0), end(0), status(DECODE_FULL),
+		  sync(NO_SYNC), stop(0), overflowstatus(DECODE_FULL)
+	{
+	}
+};
+
+// The bytes of the compressed file one round of slices reads
+class SliceWindow
+{
+public:
+	vector<unsigned char> bytes;
+	unsigned long long base;		// file offset of bytes[0]
+
+	SliceWindow()
+		: base(0)
+	{
+	}
+
+	/* Reads up to length bytes of infile from offset. False if none could be read */
+	bool load(ifstream &infile, unsigned long long offset, size_t length)
+	{
+		base = offset;
+		bytes.resize(length);
+		infile.clear();
+		infile.seekg(offset);
+		infile.read((char*)&bytes[0], length);
+		bytes.resize(size_t(infile.gcount()));
+		return !bytes.empty();
+	}
+};
+
+/* A reader positioned at bit offset pos of the file, which must lie inside window */
+class SliceReader
+{
+private:
+	unsigned long long base_;
+
+public:
+	BitReader bits;
+
+	SliceReader(const SliceWindow &window, unsigned long long pos)
+		: base_(pos & ~7ull), bits(&window.bytes[0] + size_t((pos >> 3) - window.base),
+			window.bytes.size() - size_t((pos >> 3) - window.base))
+	{
+		bits.refill();
+		bits.consume(int(pos & 7));
+	}
+
+	unsigned long long position() const
+	{
+		return base_ + bits.position();
+	}
+};
+
+/*	Decodes slice from its start until the first code boundary at or past its
+	limit, recording where the first codes began. */
+void decodeSlice(const HuffDecoder<unsigned char> &decoder, int maxlength,
+	const SliceWindow &data, Slice &slice)
+{
+	SliceReader in(data, slice.start);
+	unsigned long long pos = slice.start;
+	slice.out.reserve(size_t((slice.limit - slice.start) / 4));
+
+	size_t count;
+	unsigned char symbol;
+	while (pos < slice.limit && slice.starts.size() < SYNC_SYMBOLS)
+	{
+		slice.starts.push_back(pos);
+		slice.status = decoder.decode(in.bits, &symbol, 1, count);
+		if (slice.status != DECODE_FULL)
+			return;
+		slice.out.push_back(symbol);
+		pos = in.position();
+	}
+
+	// no code is longer than maxlength bits, so this many can't run past limit
+	while (pos < slice.limit)
+	{
+		size_t batch = max<unsigned long long>(1, (slice.limit - pos) / maxlength);
+		size_t old = slice.out.size();
+		slice.out.resize(old + batch);
+		slice.status = decoder.decode(in.bits, &slice.out[old], batch, count);
+		slice.out.resize(old + count);
+		if (slice.status != DECODE_FULL)
+			return;
+		pos = in.position();
+	}
+	slice.end = pos;
+}
+
+/*	Keeps decoding from the end of slice until a code boundary lines up with
+	one recorded by next. */
+void decodeOverflow(const HuffDecoder<unsigned char> &decoder,
+	const SliceWindow &data, Slice &slice, const Slice &next)
+{
+	SliceReader in(data, slice.end);
+	unsigned long long pos = slice.end;
+	size_t j = 0;
+
+	for (;;)
+	{
+		while (j < next.starts.size() && next.starts[j] < pos)
+			j++;
+		if (j == next.starts.size())
+			break;
+		if (next.starts[j] == pos)
+		{
+			slice.sync = j;
+			break;
+		}
+
+		size_t count;
+		unsigned char symbol;
+		slice.overflowstatus = decoder.decode(in.bits, &symbol, 1, count);
+		if (slice.overflowstatus != DECODE_FULL)
+			break;
+		slice.overflow.push_back(symbol);
+		pos = in.position();
+	}
+	slice.stop = pos;
+}
+
+/*	Uncompresses an original-format srcFile into destFile on up to threads
+	threads (0 for one per core). Block format files are handed to unhuff. */
+bool HuffTree::unhuffParallel(const string &srcFileName, const string &destFileName, int threads)
+{
+	if (isBlockFile(srcFileName))
+		return unhuffBlocks(srcFileName, destFileName);
+
+	ifstream infile(srcFileName.c_str(), ios::binary);
+	if (!infile)
+		return false;
+	infile.seekg(0, ios::end);
+	const unsigned long long totalbits = 8ull * (unsigned long long)infile.tellg();
+
+	SliceWindow data;
+	if (!data.load(infile, 0, HEADER_BYTES))
+		return false;
+	BitReader header(&data.bytes[0], data.bytes.size());
+	HuffPtr hufftree = treeFromHeader(header);
+	if (hufftree == NULL)
+		return false;
+	CodeMap *huffcodes = hufftree->generateHuffCodes();
+	HuffDecoder<unsigned char> *decoder = HuffDecoder<unsigned char>::create(*huffcodes);
+	const int maxlength = maxCodeLength(*huffcodes);
+
+	if (threads <= 0)
+		threads = max(1u, thread::hardware_concurrency());
+
+	// the last slice may run up to half a slice long, then past its limit to finish a code
+	const size_t windowsize = size_t(SLICE_BYTES * threads + SLICE_BYTES / 2) + (maxlength + 7) / 8 + 16;
+
+	ofstream outfile(destFileName.c_str());
+	unsigned long long pos = header.position();
+	DecodeStatus result = DECODE_FULL;
+	while (result == DECODE_FULL)
+	{
+		// one slice per thread, the last one running to the end of input if it's close
+		vector<Slice> slices;
+		for (int k = 0; k < threads && pos + 8 * SLICE_BYTES * k < totalbits; k++)
+		{
+			Slice slice;
+			slice.start = pos + 8 * SLICE_BYTES * k;
+			slice.limit = min(slice.start + 8 * SLICE_BYTES, totalbits);
+			if (totalbits - slice.limit < 8 * SLICE_BYTES / 2)
+				slice.limit = totalbits;
+			slices.push_back(slice);
+			if (slice.limit == totalbits)
+				break;
+		}
+		if (slices.empty() || !data.load(infile, pos >> 3, windowsize))
+		{
+			result = DECODE_TRUNCATED;
+			break;
+		}
+
+		vector<thread> pool;
+		for (size_t k = 0; k < slices.size(); k++)
+			pool.push_back(thread(decodeSlice, cref(*decoder), maxlength, cref(data), ref(slices[k])));
+		for (size_t k = 0; k < pool.size(); k++)
+			pool[k].join();
+
+		pool.clear();
+		for (size_t k = 0; k + 1 < slices.size(); k++)
+			if (slices[k].status == DECODE_FULL)
+				pool.push_back(thread(decodeOverflow, cref(*decoder), cref(data), ref(slices[k]), cref(slices[k + 1])));
+		for (size_t k = 0; k < pool.size(); k++)
+			pool[k].join();
+
+		// stitch the synchronized parts together; slice 0 starts on a known boundary
+		size_t from = 0;
+		for (size_t k = 0; k < slices.size(); k++)
+		{
+			Slice &slice = slices[k];
+			if (from < slice.out.size())
+				outfile.write((const char*)&slice.out[from], slice.out.size() - from);
+			if (slice.status != DECODE_FULL)
+			{
+				result = slice.status;
+				break;
+			}
+			pos = slice.end;
+			if (k + 1 == slices.size())
+				break;
+
+			if (!slice.overflow.empty())
+				outfile.write((const char*)&slice.overflow[0], slice.overflow.size());
+			pos = slice.stop;
+			if (slice.overflowstatus != DECODE_FULL)
+			{
+				result = slice.overflowstatus;
+				break;
+			}
+			if (slice.sync == NO_SYNC)
+				break;	// the next round starts at the last known boundary
+			from = slice.sync;
+		}
+	}
+
+	delete decoder;
+	delete huffcodes;
+	delete hufftree;
+	return result == DECODE_EOF;
+}
+
+// One thread's share of a round of input when encoding
+class EncodeSlice
+{
+public:
+	const unsigned char *data;
+	size_t length;
+	BitWriter bits;					// codes for data, padded to a whole byte
+	unsigned long long nbits;		// number of those bits that are codes
+	unsigned long long offset;		// first bit of the slice in the round's output
+	vector<unsigned char> placed;	// bits shifted right by offset % 8
+
+	EncodeSlice()
+		: data(NULL), length(0), nbits(0), offset(0)
+	{
+	}
+};
+
+/* Reads up to one round of input. False once the file is used up */
+bool readRound(ifstream &infile, vector<unsigned char> &round, size_t size)
+{
+	round.resize(size);
+	infile.read((char*)&round[0], size);
+	round.resize(size_t(infile.gcount()));
+	return !round.empty();
+}
+
+/* Cuts round into one slice per thread */
+void cutRound(const vector<unsigned char> &round, vector<EncodeSlice> &slices)
+{
+	for (size_t k = 0; k < slices.size(); k++)
+	{
+		EncodeSlice &slice = slices[k];
+		size_t start = min(round.size(), k * ENCODE_SLICE_BYTES);
+		slice.data = round.empty() ? NULL : &round[0] + start;
+		slice.length = min(ENCODE_SLICE_BYTES, round.size() - start);
+		slice.bits.bytes().clear();
+		slice.nbits = 0;
+	}
+}
+
+void encodeSlice(const HuffEncoder<unsigned char> &encoder, EncodeSlice &slice)
+{
+	if (slice.length > 0)
+		encoder.encode(slice.data, slice.length, slice.bits);
+	slice.nbits = slice.bits.bitcount();
+	slice.bits.flushbits();
+}
+
+/* Shifts the slice's bits right by the bit position of its offset within a byte */
+void placeSlice(EncodeSlice &slice)
+{
+	const vector<unsigned char> &from = slice.bits.bytes();
+	const int shift = int(slice.offset & 7);
+	slice.placed.resize(size_t((shift + slice.nbits + 7) / 8));
+	if (slice.placed.empty())
+		return;
+	if (shift == 0)
+	{
+		memcpy(&slice.placed[0], &from[0], slice.placed.size());
+		return;
+	}
+
+	unsigned char carry = 0;
+	for (size_t i = 0; i < from.size(); i++)
+	{
+		slice.placed[i] = (unsigned char)(carry | (from[i] >> shift));
+		carry = (unsigned char)(from[i] << (8 - shift));
+	}
+	if (from.size() < slice.placed.size())
+		slice.placed[from.size()] = carry;
+}
+
+/*	Compresses srcFile into destFile on up to threads threads (0 for one per
+	core). The output is the same file huff writes. */
+bool HuffTree::huffParallel(const string &srcFileName, const string &destFileName, int threads)
+{
+	ifstream infile(srcFileName.c_str(), ios::binary);
+	if (!infile)
+		return false;
+
+	if (threads <= 0)
+		threads = max(1u, thread::hardware_concurrency());
+	const size_t roundsize = ENCODE_SLICE_BYTES * threads;
+	vector<unsigned char> round;
+	vector<EncodeSlice> slices(threads);
+
+	// first pass: each thread counts its slice, then the counts are merged
+	long long counts[256] = { 0 };
+	vector<vector<long long> > slicecounts(threads, vector<long long>(256));
+	while (readRound(infile, round, roundsize))
+	{
+		cutRound(round, slices);
+		vector<thread> pool;
+		for (int k = 0; k < threads; k++)
+			if (slices[k].length > 0)
+				pool.push_back(thread(countBytes, slices[k].data, slices[k].length, &slicecounts[k][0]));
+		for (size_t k = 0; k < pool.size(); k++)
+			pool[k].join();
+	}
+	for (int k = 0; k < threads; k++)
+		for (int b = 0; b < 256; b++)
+			counts[b] += slicecounts[k][b];
+
+	Histogram *hist = countsHistogram(counts);
+	HuffPtr hufftree = buildHuffTree(*hist);
+	CodeMap *huffcodes = hufftree->generateHuffCodes();
+	HuffEncoder<unsigned char> *encoder = HuffEncoder<unsigned char>::create(*huffcodes);
+	delete huffcodes;
+	delete hist;
+
+	// second pass: code the slices, then join them after the header
+	infile.clear();
+	infile.seekg(infile.beg);
+	ofstream outfile(destFileName.c_str(), ios::binary);
+
+	BitWriter bits;
+	hufftree->writeFileHeader(bits);
+	while (readRound(infile, round, roundsize))
+	{
+		cutRound(round, slices);
+		vector<thread> pool;
+		for (int k = 0; k < threads; k++)
+			pool.push_back(thread(encodeSlice, cref(*encoder), ref(slices[k])));
+		for (size_t k = 0; k < pool.size(); k++)
+			pool[k].join();
+
+		// the bits left over from the last round come first
+		unsigned long long offset = bits.nbits();
+		for (int k = 0; k < threads; k++)
+		{
+			slices[k].offset = offset;
+			offset += slices[k].nbits;
+		}
+
+		pool.clear();
+		for (int k = 0; k < threads; k++)
+			pool.push_back(thread(placeSlice, ref(slices[k])));
+		for (size_t k = 0; k < pool.size(); k++)
+			pool[k].join();
+
+		// slices meeting inside a byte share it; everything else is copied as is
+		vector<unsigned char> &out = bits.bytes();
+		size_t base = out.size();
+		out.resize(base + size_t((offset + 7) / 8));
+		if (bits.nbits() > 0)
+			out[base] = (unsigned char)(bits.pendingBits() << (8 - bits.nbits()));
+		for (int k = 0; k < threads; k++)
+		{
+			const vector<unsigned char> &placed = slices[k].placed;
+			if (placed.empty())
+				continue;
+			size_t at = base + size_t(slices[k].offset / 8);
+			out[at] |= placed[0];
+			if (placed.size() > 1)
+				memcpy(&out[at + 1], &placed[1], placed.size() - 1);
+		}
+
+		// keep the last partial byte in the accumulator, write the rest
+		int partial = int(offset & 7);
+		unsigned int last = partial > 0 ? out.back() >> (8 - partial) : 0;
+		if (partial > 0)
+			out.pop_back();
+		if (!out.empty())
+			outfile.write((const char*)&out[0], out.size());
+		bits = BitWriter();
+		bits.put(partial, last);
+	}
+	encoder->encodeEOF(bits);
+	bits.flushbits();
+	outfile.write((const char*)&bits.bytes()[0], bits.bytes().size());
+
+	delete encoder;
+	delete hufftree;
+	return bool(outfile);
+}
@@ -0,0 +1,239 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Pipelined versions of HuffTree::huff and HuffTree::unhuff. A
+	reader thread, the coding loop and a writer thread are connected by
+	bounded queues of large buffers, so disk reads and writes overlap with
+	coding instead of alternating with it. The files produced and accepted
+	are identical to the ones huff/unhuff use.
+*/
+
+#include "hufftree.h"
+#include <thread>
+#include <functional>
+#include <vector>
+#include <cstring>
+#include "boundedqueue.h"
+#include "huffkernels.h"
+#include "bytecounts.h"
+
+using namespace std;
+
+// Intermediate functions for building the Huffman Tree
+Histogram* countsHistogram(const long long counts[256]);
+
+// number of buffers in flight between two stages, and their size
+const int PIPE_DEPTH = 4;
+const int PIPE_BUFFER_SIZE = 1 << 20;
+
+// one block of file data moving between stages
+typedef vector<unsigned char> IoBuffer;
+
+/*	A fixed set of buffers cycling between two stages: the producer takes
+	buffers from spare and hands them to the consumer through filled, the
+	consumer returns them to spare when it is done with them. */
+class BufferPipe
+{
+public:
+	BoundedQueue<IoBuffer*> spare;
+	BoundedQueue<IoBuffer*> filled;
+
+	BufferPipe()
+		: spare(PIPE_DEPTH), filled(PIPE_DEPTH), buffers_(PIPE_DEPTH)
+	{
+		for (int i = 0; i < PIPE_DEPTH; i++)
+		{
+			buffers_[i].reserve(PIPE_BUFFER_SIZE);
+			spare.push(&buffers_[i]);
+		}
+	}
+
+	// unblocks both stages, e.g. when the consumer stops early
+	void close()
+	{
+		spare.close();
+		filled.close();
+	}
+
+private:
+	vector<IoBuffer> buffers_;
+};
+
+/* Reader stage: fills buffers from infile until end of file */
+void readStage(istream &infile, BufferPipe &pipe)
+{
+	IoBuffer *buf;
+	while (pipe.spare.pop(buf))
+	{
+		buf->resize(PIPE_BUFFER_SIZE);
+		infile.read((char*)&(*buf)[0], buf->size());
+		buf->resize(size_t(infile.gcount()));
+
+		if (buf->empty() || !pipe.filled.push(buf))
+			break;
+	}
+	pipe.filled.close();
+}
+
+/* Writer stage: empties buffers into outfile until the producer closes the pipe */
+void writeStage(ostream &outfile, BufferPipe &pipe)
+{
+	IoBuffer *buf;
+	while (pipe.filled.pop(buf))
+	{
+		if (!buf->empty())
+			outfile.write((const char*)&(*buf)[0], buf->size());
+		pipe.spare.push(buf);
+	}
+}
+
+/* Feeds the buffers coming out of a pipe into a BitReader */
+class PipeSource : public ByteSource
+{
+private:
+	BufferPipe &pipe_;
+	IoBuffer *current_;
+	size_t pos_;
+
+public:
+	PipeSource(BufferPipe &pipe)
+		: pipe_(pipe), current_(NULL), pos_(0)
+	{
+	}
+
+	size_t read(unsigned char *buf, size_t n)
+	{
+		while (current_ == NULL || pos_ == current_->size())
+		{	// hand the used buffer back to the reader and wait for the next one
+			if (current_)
+				pipe_.spare.push(current_);
+			current_ = NULL;
+			pos_ = 0;
+			if (!pipe_.filled.pop(current_))
+				return 0;
+		}
+
+		size_t count = min(n, current_->size() - pos_);
+		memcpy(buf, &(*current_)[pos_], count);
+		pos_ += count;
+		return count;
+	}
+};
+
+/* Hands the whole bytes held by a BitWriter to the writer stage */
+bool sendBits(BitWriter &bits, BufferPipe &pipe)
+{
+	IoBuffer *buf;
+	if (!pipe.spare.pop(buf))
+		return false;
+
+	// swap storage instead of copying; the writer keeps the filled bytes
+	buf->swap(bits.bytes());
+	bits.bytes().clear();
+	return pipe.filled.push(buf);
+}
+
+/* Compresses srcFile into destFile, overlapping I/O with coding */
+bool HuffTree::huffPipelined(const string &srcFileName, const string &destFileName)
+{
+	ifstream infile(srcFileName.c_str());
+	if (!infile)
+		return false;
+
+	// first pass: count bytes while the next buffer is being read
+	long long counts[256] = { 0 };
+	{
+		BufferPipe input;
+		thread reader(readStage, ref(infile), ref(input));
+
+		IoBuffer *buf;
+		while (input.filled.pop(buf))
+		{
+			countBytes(buf->empty() ? NULL : &(*buf)[0], buf->size(), counts);
+			input.spare.push(buf);
+		}
+		reader.join();
+	}
+
+	Histogram *hist = countsHistogram(counts);
+	HuffPtr hufftree = buildHuffTree(*hist);
+	CodeMap *huffcodes = hufftree->generateHuffCodes();
+	HuffEncoder<unsigned char> *encoder = HuffEncoder<unsigned char>::create(*huffcodes);
+	delete huffcodes;
+	delete hist;
+
+	// second pass: read -> code -> write
+	infile.clear();
+	infile.seekg(infile.beg);
+	ofstream outfile(destFileName.c_str(), ios::binary);
+
+	BufferPipe input, output;
+	thread reader(readStage, ref(infile), ref(input));
+	thread writer(writeStage, ref(outfile), ref(output));
+
+	BitWriter bits;
+	hufftree->writeFileHeader(bits);
+
+	IoBuffer *buf;
+	while (input.filled.pop(buf))
+	{
+		encoder->encode(&(*buf)[0], buf->size(), bits);
+		input.spare.push(buf);
+		sendBits(bits, output);
+	}
+	encoder->encodeEOF(bits);
+	bits.flushbits();
+	sendBits(bits, output);
+
+	output.filled.close();
+	reader.join();
+	writer.join();
+
+	delete encoder;
+	delete hufftree;
+	return true;
+}
+
+/* Uncompresses srcFile into destFile, overlapping I/O with decoding */
+bool HuffTree::unhuffPipelined(const string &srcFileName, const string &destFileName)
+{
+	if (isBlockFile(srcFileName))
+		return unhuffBlocks(srcFileName, destFileName);
+
+	ifstream infile(srcFileName.c_str(), ios::binary);
+	if (!infile)
+		return false;
+	ofstream outfile(destFileName.c_str());
+
+	BufferPipe input, output;
+	thread reader(readStage, ref(infile), ref(input));
+	thread writer(writeStage, ref(outfile), ref(output));
+
+	PipeSource source(input);
+	BitReader bits(source);
+	HuffPtr hufftree = treeFromHeader(bits);
+	CodeMap *huffcodes = hufftree ? hufftree->generateHuffCodes() : NULL;
+	HuffDecoder<unsigned char> *decoder = huffcodes ? HuffDecoder<unsigned char>::create(*huffcodes) : NULL;
+
+	DecodeStatus status = decoder ? DECODE_FULL : DECODE_TRUNCATED;
+	IoBuffer *buf;
+	while (status == DECODE_FULL && output.spare.pop(buf))
+	{
+		size_t count;
+		buf->resize(PIPE_BUFFER_SIZE);
+		status = decoder->decode(bits, &(*buf)[0], buf->size(), count);
+		buf->resize(count);
+		output.filled.push(buf);
+	}
+
+	// stop the reader in case the stream ended before the file did
+	input.close();
+	output.filled.close();
+	reader.join();
+	writer.join();
+
+	delete decoder;
+	delete huffcodes;
+	delete hufftree;
+	return status == DECODE_EOF;
+}
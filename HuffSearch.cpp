@@ -0,0 +1,267 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Searching original-format .hf files for a literal string
+	without decompressing them.
+
+	Every byte always gets the same code, so an occurrence of the pattern is
+	the concatenation of its bytes' codes, starting at some code boundary.
+	The stream is scanned for that bit string at all eight alignments within
+	a byte. A bit match is only an occurrence if it begins on a code
+	boundary. A second reader confirms each candidate as soon as the scan
+	finds one: it decodes forward into a scratch buffer, only counting
+	symbols, up to the candidate, and the count there is the occurrence's
+	byte offset. Counting ends at the last candidate, and a pattern whose
+	bits never appear decodes nothing at all.
+
+	The file is scanned SEARCH_CHUNK_BYTES at a time, keeping the pattern's
+	length of the previous chunk so matches across the cut are found, so
+	memory stays the same however large the file or however many matches.
+
+	Block format files are decoded a block at a time and each block searched
+	directly, with the pattern's length less one of the text before it in
+	front so matches across the cut are found. Memory stays a block or so.
+*/
+
+#include "hufftree.h"
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include "bitbuffer.h"
+#include "huffkernels.h"
+#include "huffformat.h"
+#include "tablecache.h"
+
+using namespace std;
+
+// symbols decoded per call while counting up to a candidate
+const size_t COUNT_BATCH_SYMBOLS = 1 << 16;
+
+// compressed bytes read per step of the scan
+const size_t SEARCH_CHUNK_BYTES = 1 << 20;
+
+// pattern bits compared at each position before a candidate is checked in full
+const int SEARCH_PREFIX_BITS = 56;
+
+/* The 64 bits of data starting at byte i, most significant first. data is padded by 8 bytes */
+inline unsigned long long loadWindow(const unsigned char *data, size_t i)
+{
+	unsigned long long w = 0;
+	for (int k = 0; k < 8; k++)
+		w = (w << 8) | data[i + k];
+	return w;
+}
+
+/* The 32 bits of data starting at bit pos */
+inline unsigned int bitsAt(const unsigned char *data, unsigned long long pos)
+{
+	return (unsigned int)(loadWindow(data, size_t(pos >> 3)) >> (32 - int(pos & 7)));
+}
+
+/* true if the nbits bits of pattern appear in data at bit pos */
+bool bitsMatch(const unsigned char *data, unsigned long long pos, const vector<unsigned char> &pattern,
+	unsigned long long nbits)
+{
+	for (unsigned long long done = 0; done < nbits; done += 32)
+	{
+		int n = nbits - done < 32 ? int(nbits - done) : 32;
+		unsigned int mask = n == 32 ? ~0u : ~(~0u >> n);
+		if (((bitsAt(data, pos + done) ^ bitsAt(&pattern[0], done)) & mask) != 0)
+			return false;
+	}
+	return true;
+}
+
+/* Feeds the bytes of a file to a BitReader */
+class FileSource : public ByteSource
+{
+private:
+	ifstream &in_;
+
+public:
+	FileSource(ifstream &in)
+		: in_(in)
+	{
+	}
+
+	size_t read(unsigned char *buf, size_t n)
+	{
+		in_.read((char*)buf, n);
+		return size_t(in_.gcount());
+	}
+};
+
+/* Appends the offset of every occurrence of pattern in text, counting text as starting at base */
+void searchBytes(const vector<unsigned char> &text, const string &pattern, unsigned long long base,
+	vector<unsigned long long> &offsets)
+{
+	vector<unsigned char>::const_iterator it = text.begin();
+	while ((it = search(it, text.end(), pattern.begin(), pattern.end())) != text.end())
+	{
+		offsets.push_back(base + (unsigned long long)(it - text.begin()));
+		it++;
+	}
+}
+
+/*	Decodes a block format file a block at a time, searching each block
+	behind the last pattern.size() - 1 bytes of the one before. Fails on
+	any damaged block, as decompressing the file would. */
+bool HuffTree::searchBlocks(istream &infile, const string &pattern, vector<unsigned long long> &offsets)
+{
+	HuffFileInfo info;
+	if (!readFormatHeader(infile, info))
+		return false;
+
+	BlockRecord record;
+	vector<unsigned char> block, text;
+	TableWindow window(HF_TABLE_WINDOW);
+	unsigned long long written = 0;
+	RecordStatus status;
+	for (unsigned int index = 0; (status = readBlockRecord(infile, info, record)) == RECORD_OK; index++)
+	{
+		CodeTablePtr table;
+		if (record.tableref != HF_INLINE_TABLE)
+			table = window.table(record.tableref);
+
+		bool good = decodeBlock(info, record, table, block);
+		if (record.tableref == HF_INLINE_TABLE)
+			window.add(index, string(), table);
+		if (!good)
+			return false;
+
+		// text holds the tail of the last block, which ends at written
+		text.insert(text.end(), block.begin(), block.end());
+		searchBytes(text, pattern, written + block.size() - text.size(), offsets);
+		written += block.size();
+		text.erase(text.begin(), text.end() - min(text.size(), pattern.size() - 1));
+	}
+
+	if ((info.flags & HF_LENGTHS) && written != info.length)
+		return false;
+	return status == RECORD_END;
+}
+
+/*	Finds every occurrence of pattern in the compressed file, appending the
+	byte offsets in the uncompressed data to offsets in increasing order.
+	Returns false if the file can't be read or isn't a valid compressed file. */
+bool HuffTree::search(const string &fileName, const string &pattern, vector<unsigned long long> &offsets)
+{
+	offsets.clear();
+	ifstream infile(fileName.c_str(), ios::binary);
+	if (!infile || pattern.empty())
+		return false;
+	infile.seekg(0, ios::end);
+	const unsigned long long totalbits = 8ull * (unsigned long long)infile.tellg();
+	infile.seekg(0, ios::beg);
+	if (totalbits == 0)
+		return false;
+
+	if (isBlockFile(fileName))
+	{
+		if (searchBlocks(infile, pattern, offsets))
+			return true;
+		offsets.clear();
+		return false;
+	}
+
+	// the counting reader; it stays behind the scan, reading the same file
+	FileSource source(infile);
+	BitReader in(source);
+	HuffPtr hufftree = treeFromHeader(in);
+	if (hufftree == NULL)
+		return false;
+	CodeMap *huffcodes = hufftree->generateHuffCodes();
+	const int maxlength = maxCodeLength(*huffcodes);
+	const unsigned long long start = in.position();
+
+	// the pattern as the stream would code it; a byte with no code means no occurrences.
+	// A tree read from a header keys each byte by the 9 bits its leaf was written with
+	BitWriter patternbits;
+	for (size_t i = 0; i < pattern.size(); i++)
+	{
+		CodeMap::const_iterator code = huffcodes->find(int(pattern[i]) & 0x1FF);
+		if (code == huffcodes->end())
+		{
+			delete huffcodes;
+			delete hufftree;
+			return true;
+		}
+		patternbits.writebits(code->second.first, code->second.second);
+	}
+	const unsigned long long nbits = patternbits.bitcount();
+	patternbits.flushbits();
+	patternbits.bytes().resize(patternbits.bytes().size() + 8);
+
+	// the pattern's first bits, placed at each of the eight bit positions of a window
+	const int prefixbits = int(min<unsigned long long>(nbits, SEARCH_PREFIX_BITS));
+	const unsigned long long prefix = loadWindow(&patternbits.bytes()[0], 0) >> (64 - prefixbits);
+	unsigned long long masks[8], values[8];
+	for (int a = 0; a < 8; a++)
+	{
+		masks[a] = (~0ull >> (64 - prefixbits)) << (64 - prefixbits - a);
+		values[a] = prefix << (64 - prefixbits - a);
+	}
+
+	HuffDecoder<unsigned char> *decoder = HuffDecoder<unsigned char>::create(*huffcodes);
+	vector<unsigned char> scratch(COUNT_BATCH_SYMBOLS);
+	unsigned long long symbols = 0, counted = start;
+	DecodeStatus status = DECODE_FULL;
+
+	// a match starting in a window's last keep bytes may run past it, so those wait for the next chunk
+	const size_t keep = size_t((nbits + 7) / 8) + 16;
+	ifstream scanfile(fileName.c_str(), ios::binary);
+	unsigned long long base = start >> 3;	// file offset of window[0]
+	scanfile.seekg(base);
+	vector<unsigned char> window;
+	bool more = true;
+	while (more && status == DECODE_FULL)
+	{
+		size_t old = window.size();
+		window.resize(old + SEARCH_CHUNK_BYTES);
+		scanfile.read((char*)&window[old], SEARCH_CHUNK_BYTES);
+		window.resize(old + size_t(scanfile.gcount()));
+		more = scanfile.gcount() == (streamsize)SEARCH_CHUNK_BYTES;
+
+		size_t stop = window.size();
+		if (more)
+			stop = stop > keep ? stop - keep : 0;
+		else
+			window.resize(window.size() + keep);	// the last chunk's padding
+
+		const unsigned char *bytes = &window[0];
+		for (size_t i = 0; i < stop && 8 * (base + i) + nbits <= totalbits && status == DECODE_FULL; i++)
+		{
+			unsigned long long w = loadWindow(bytes, i);
+			for (int a = 0; a < 8 && status == DECODE_FULL; a++)
+			{
+				if ((w & masks[a]) != values[a])
+					continue;
+				unsigned long long pos = 8 * (base + i) + a;
+				if (pos < start || pos + nbits > totalbits ||
+					(nbits > (unsigned long long)prefixbits && !bitsMatch(bytes, pos - 8 * base, patternbits.bytes(), nbits)))
+					continue;
+
+				// count symbols up to the candidate; it's an occurrence if it falls on a code boundary
+				while (counted < pos && status == DECODE_FULL)
+				{
+					// no code is longer than maxlength bits, so this many can't run past the candidate
+					size_t batch = size_t(max<unsigned long long>(1, (pos - counted) / max(1, maxlength)));
+					size_t count;
+					status = decoder->decode(in, &scratch[0], min(batch, scratch.size()), count);
+					symbols += count;
+					counted = in.position();
+				}
+				if (counted == pos && status == DECODE_FULL)
+					offsets.push_back(symbols);
+			}
+		}
+
+		window.erase(window.begin(), window.begin() + stop);
+		base += stop;
+	}
+
+	delete decoder;
+	delete huffcodes;
+	delete hufftree;
+	return status != DECODE_TRUNCATED;
+}
@@ -0,0 +1,162 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Code tables for the block format that come from the shared
+	TableCache (tablecache.h) instead of being rebuilt for every block.
+
+	Encoding looks tables up by a quantized histogram: each symbol's share of
+	the block is rounded to a quarter of a power of two, so blocks whose
+	statistics differ only by noise get the same key. The table is built from
+	the rounded counts rather than the first block's exact ones, so the codes
+	for a key never depend on what was compressed before.
+
+	Decoding looks tables up by the bits of the tree header, which identify
+	the tree exactly.
+*/
+
+#include "hufftree.h"
+#include <algorithm>
+#include "bitbuffer.h"
+#include "huffkernels.h"
+#include "tablecache.h"
+#include "globals.h"
+
+using namespace std;
+
+// size of the symbol chunks handed to the decode kernel
+const int SYMBOL_CHUNK_SIZE = 1 << 16;
+
+/*	Rounds count, as a share of total scaled to 2^16, to 2 bits below its
+	leading bit. Returns the bucket (1..63, 0 for an absent symbol) and sets
+	rounded to the count the bucket stands for. */
+int quantizeCount(int count, long long total, int &rounded)
+{
+	if (count == 0)
+	{
+		rounded = 0;
+		return 0;
+	}
+
+	long long v = max(1LL, (long long)count * 65536 / total);
+	int e = 0;
+	while ((v >> (e + 1)) != 0)
+		e++;
+	if (e < 2)
+	{
+		rounded = int(v);
+		return int(v);
+	}
+
+	int frac = int(v >> (e - 2)) & 3;
+	rounded = (4 + frac) << (e - 2);
+	return 4 * (e - 1) + frac;
+}
+
+/* Builds a table from exact symbol counts; not cached, since exact counts rarely repeat */
+CodeTablePtr HuffTree::exactTable(const vector<int> &counts)
+{
+	Histogram hist;
+	for (size_t s = 0; s < counts.size(); s++)
+		if (counts[s] > 0)
+			hist[int(s)] = counts[s];
+	hist[PSEUDO_EOF] = 1;
+
+	HuffPtr hufftree = buildHuffTree(hist);
+	return CodeTablePtr(new CodeTable(hufftree, hufftree->generateHuffCodes()));
+}
+
+/* Returns the shared table for blocks with about these symbol counts, and its cache key */
+CodeTablePtr HuffTree::tableForCounts(const vector<int> &counts, string &key)
+{
+	long long total = 0;
+	for (size_t s = 0; s < counts.size(); s++)
+		total += counts[s];
+
+	Histogram hist;
+	key.assign(1, 'H');
+	for (size_t s = 0; s < counts.size(); s++)
+	{
+		int rounded;
+		key += char(quantizeCount(counts[s], total, rounded));
+		if (rounded > 0)
+			hist[int(s)] = rounded;
+	}
+	hist[PSEUDO_EOF] = 1;
+
+	TableCache &cache = TableCache::shared();
+	CodeTablePtr table = cache.find(key);
+	if (!table)
+	{
+		HuffPtr hufftree = buildHuffTree(hist);
+		table = CodeTablePtr(new CodeTable(hufftree, hufftree->generateHuffCodes()));
+		cache.insert(key, table);
+	}
+	return table;
+}
+
+/* Reads a tree header and returns its table. NULL if the header is damaged */
+CodeTablePtr HuffTree::tableFromHeader(BitReader &infile)
+{
+	HuffPtr hufftree = treeFromHeader(infile);
+	if (hufftree == NULL)
+		return CodeTablePtr();
+
+	// the header's own bits are the key; headers are prefix free, so padding can't collide
+	BitWriter header;
+	hufftree->writeFileHeader(header);
+	header.flushbits();
+	string key(1, 'T');
+	key.append(header.bytes().begin(), header.bytes().end());
+
+	TableCache &cache = TableCache::shared();
+	CodeTablePtr table = cache.find(key);
+	if (table)
+	{
+		delete hufftree;
+		return table;
+	}
+
+	table = CodeTablePtr(new CodeTable(hufftree, hufftree->generateHuffCodes()));
+	cache.insert(key, table);
+	return table;
+}
+
+/* Writes the codes for symbols, then PSEUDO_EOF */
+void HuffTree::writeCodes(const CodeTable &table, const unsigned short *symbols, size_t count, BitWriter &outfile)
+{
+	table.encoder->encode(symbols, count, outfile);
+	table.encoder->encodeEOF(outfile);
+}
+
+/* Decodes symbols up to PSEUDO_EOF. False if the input runs out first */
+bool HuffTree::readCodes(const CodeTable &table, BitReader &infile, vector<unsigned short> &symbols)
+{
+	symbols.clear();
+	DecodeStatus status;
+	do
+	{
+		size_t start = symbols.size(), count;
+		symbols.resize(start + SYMBOL_CHUNK_SIZE);
+		status = table.decoder->decode(infile, &symbols[start], SYMBOL_CHUNK_SIZE, count);
+		symbols.resize(start + count);
+	} while (status == DECODE_FULL);
+
+	return status == DECODE_EOF;
+}
+
+/* Decodes exactly count symbols into symbols. False if the input runs out first */
+bool HuffTree::readCodes(const CodeTable &table, BitReader &infile, size_t count, vector<unsigned short> &symbols)
+{
+	symbols.resize(count);
+	if (count == 0)
+		return true;
+	return table.decoder->decodeCounted(infile, &symbols[0], count) == DECODE_FULL;
+}
+
+/* Reads one code and checks that it is PSEUDO_EOF */
+bool HuffTree::readEOF(const CodeTable &table, BitReader &infile)
+{
+	unsigned short symbol;
+	size_t count;
+	return table.decoder->decode(infile, &symbol, 1, count) == DECODE_EOF;
+}
@@ -0,0 +1,218 @@
+#pragma once
+#ifndef _BITBUFFER_H
+#define _BITBUFFER_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: In-memory bit streams used by the encode/decode kernels. Bits are
+	packed most-significant first, the same layout obstream/ibstream use, so a
+	buffer written here can be spliced into (or read out of) a .hf file.
+
+	Both classes also provide writebits()/readbits() with the same signatures
+	as obstream/ibstream so the header code can target either kind of stream.
+*/
+
+#include <vector>
+#include <cstddef>
+
+// ---- Source of bytes for a BitReader that doesn't own all of its input ---- //
+class ByteSource
+{
+public:
+	virtual ~ByteSource() {}
+
+	// fills buf with up to n bytes, returns the number of bytes read (0 at end)
+	virtual size_t read(unsigned char *buf, size_t n) = 0;
+};
+
+// ---- Packs variable length codes into a byte vector ---- //
+class BitWriter
+{
+private:
+	std::vector<unsigned char> bytes_;
+	unsigned long long acc_;	// pending bits, right-aligned
+	int nbits_;					// number of valid bits in acc_
+
+public:
+	BitWriter()
+		: acc_(0), nbits_(0)
+	{
+	}
+
+	/* Appends the low length bits of code. Caller guarantees nbits() + length <= 64 */
+	void put(int length, unsigned int code)
+	{
+		acc_ = (acc_ << length) | code;
+		nbits_ += length;
+	}
+
+	/* Moves whole 32-bit words out of the accumulator */
+	void emitWord()
+	{
+		if (nbits_ >= 32)
+		{
+			nbits_ -= 32;
+			unsigned int w = (unsigned int)(acc_ >> nbits_);
+			bytes_.push_back((unsigned char)(w >> 24));
+			bytes_.push_back((unsigned char)(w >> 16));
+			bytes_.push_back((unsigned char)(w >> 8));
+			bytes_.push_back((unsigned char)w);
+		}
+	}
+
+	/* Moves every whole byte out of the accumulator */
+	void emitBytes()
+	{
+		while (nbits_ >= 8)
+		{
+			nbits_ -= 8;
+			bytes_.push_back((unsigned char)(acc_ >> nbits_));
+		}
+	}
+
+	/* obstream-compatible write of an arbitrary number of bits */
+	void writebits(int length, int value)
+	{
+		while (length > 24)
+		{	// keep each put() well inside the accumulator
+			length -= 24;
+			put(24, (unsigned int)(value >> length) & 0xFFFFFF);
+			emitBytes();
+		}
+		put(length, (unsigned int)value & ((1u << length) - 1));
+		emitBytes();
+	}
+
+	/* Pads the final partial byte with zeros, like obstream::flushbits */
+	void flushbits()
+	{
+		emitBytes();
+		if (nbits_ > 0)
+		{
+			bytes_.push_back((unsigned char)(acc_ << (8 - nbits_)));
+			acc_ = 0;
+			nbits_ = 0;
+		}
+	}
+
+	// bits still held in the accumulator (always < 8 after emitBytes)
+	int nbits() const { return nbits_; }
+	unsigned int pendingBits() const { return (unsigned int)(acc_ & ((1u << nbits_) - 1)); }
+
+	// total bits written so far, including the ones not yet emitted
+	unsigned long long bitcount() const { return 8ull * bytes_.size() + nbits_; }
+
+	std::vector<unsigned char>& bytes() { return bytes_; }
+	const std::vector<unsigned char>& bytes() const { return bytes_; }
+};
+
+// ---- Reads variable length codes out of a byte buffer ---- //
+class BitReader
+{
+private:
+	ByteSource *src_;					// NULL when the whole input was given up front
+	std::vector<unsigned char> chunk_;	// storage for bytes pulled from src_
+	const unsigned char *base_;			// first byte of the current input
+	const unsigned char *next_;
+	const unsigned char *end_;
+	unsigned long long before_;			// bytes of input ahead of base_
+	unsigned long long acc_;			// unread bits, right-aligned
+	int nbits_;							// valid bits in acc_, including padding
+	int padbits_;						// zero bits appended past the end of input
+
+	enum { CHUNK_SIZE = 1 << 16 };
+
+	bool fill()
+	{
+		if (src_ == NULL)
+			return false;
+		chunk_.resize(CHUNK_SIZE);
+		size_t n = src_->read(&chunk_[0], chunk_.size());
+		before_ += end_ - base_;
+		base_ = next_ = &chunk_[0];
+		end_ = next_ + n;
+		return n > 0;
+	}
+
+public:
+	BitReader(const unsigned char *data, size_t n)
+		: src_(NULL), base_(data), next_(data), end_(data + n), before_(0), acc_(0), nbits_(0), padbits_(0)
+	{
+	}
+
+	explicit BitReader(ByteSource &src)
+		: src_(&src), base_(NULL), next_(NULL), end_(NULL), before_(0), acc_(0), nbits_(0), padbits_(0)
+	{
+	}
+
+	/* Tops the accumulator up to at least 57 bits, zero-padding past the end */
+	void refill()
+	{
+		while (nbits_ <= 56)
+		{
+			if (next_ == end_ && !fill())
+			{
+				acc_ <<= 8;
+				padbits_ += 8;
+			}
+			else
+				acc_ = (acc_ << 8) | *next_++;
+			nbits_ += 8;
+		}
+	}
+
+	/* Returns the next n bits (n <= 32) without consuming them; needs refill() */
+	unsigned int peek(int n) const
+	{
+		return (unsigned int)(acc_ >> (nbits_ - n)) & (unsigned int)((1ull << n) - 1);
+	}
+
+	void consume(int n)
+	{
+		nbits_ -= n;
+	}
+
+	int bit()
+	{
+		if (nbits_ == 0)
+			refill();
+		return (int)(acc_ >> --nbits_) & 1;
+	}
+
+	/* ibstream-compatible read of up to 32 bits. Returns false past end of input */
+	bool readbits(int n, int &value)
+	{
+		if (nbits_ < n)
+			refill();
+		if (nbits_ - n < padbits_)
+			return false;
+		value = (int)peek(n);
+		consume(n);
+		return true;
+	}
+
+	// bits consumed so far, counting any zero padding read past the end
+	unsigned long long position() const 
+	{ 
+		return 8 * (before_ + (next_ - base_)) + padbits_ - nbits_; 
+	}
+
+	// true once a read has gone past the last real bit of input
+	bool overrun() const { return nbits_ < padbits_; }
+
+	// true when no unread input bits remain
+	bool exhausted()
+	{
+		refill();
+		return nbits_ <= padbits_;
+	}
+
+	/* Skips to the next byte boundary of the underlying input */
+	void alignToByte()
+	{
+		consume((nbits_ - padbits_) % 8);
+	}
+};
+
+#endif
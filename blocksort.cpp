@@ -0,0 +1,301 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of the block-sorting front end declared in
+	blocksort.h.
+*/
+
+#include "blocksort.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+// bucket boundaries for each symbol: starts, or one past the ends
+void getBuckets(const int *s, int n, int alphabet, vector<int> &bucket, bool ends)
+{
+	fill(bucket.begin(), bucket.end(), 0);
+	for (int i = 0; i < n; i++)
+		bucket[s[i]]++;
+	int sum = 0;
+	for (int c = 0; c < alphabet; c++)
+	{
+		sum += bucket[c];
+		bucket[c] = ends ? sum : sum - bucket[c];
+	}
+}
+
+/* Induces the order of L-type, then S-type suffixes from the ones already placed */
+void induceSort(const int *s, int *sa, int n, int alphabet, const vector<bool> &stype, vector<int> &bucket)
+{
+	getBuckets(s, n, alphabet, bucket, false);
+	for (int i = 0; i < n; i++)
+	{
+		int j = sa[i] - 1;
+		if (sa[i] > 0 && !stype[j])
+			sa[bucket[s[j]]++] = j;
+	}
+
+	getBuckets(s, n, alphabet, bucket, true);
+	for (int i = n - 1; i >= 0; i--)
+	{
+		int j = sa[i] - 1;
+		if (sa[i] > 0 && stype[j])
+			sa[--bucket[s[j]]] = j;
+	}
+}
+
+/*	Suffix array by induced sorting (SA-IS), linear in n regardless of how
+	repetitive the input is. s[n - 1] must be a unique smallest symbol 0. */
+void suffixArrayIS(const int *s, int *sa, int n, int alphabet)
+{
+	// classify suffixes: S-type sorts before its successor, L-type after
+	vector<bool> stype(n);
+	stype[n - 1] = true;
+	for (int i = n - 2; i >= 0; i--)
+		stype[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && stype[i + 1]);
+
+	#define IS_LMS(i) ((i) > 0 && stype[i] && !stype[(i) - 1])
+
+	// sort the leftmost-S substrings by placing them at their bucket ends and inducing
+	vector<int> bucket(alphabet);
+	getBuckets(s, n, alphabet, bucket, true);
+	fill(sa, sa + n, -1);
+	for (int i = 1; i < n; i++)
+		if (IS_LMS(i))
+			sa[--bucket[s[i]]] = i;
+	induceSort(s, sa, n, alphabet, stype, bucket);
+
+	// compact the sorted LMS substrings into the front of sa
+	int n1 = 0;
+	for (int i = 0; i < n; i++)
+		if (IS_LMS(sa[i]))
+			sa[n1++] = sa[i];
+
+	// name each LMS substring by its rank, equal substrings share a name
+	fill(sa + n1, sa + n, -1);
+	int names = 0, prev = -1;
+	for (int i = 0; i < n1; i++)
+	{
+		int pos = sa[i];
+		bool diff = false;
+		for (int d = 0; d < n; d++)
+		{
+			if (prev == -1 || s[pos + d] != s[prev + d] || stype[pos + d] != stype[prev + d])
+			{
+				diff = true;
+				break;
+			}
+			else if (d > 0 && (IS_LMS(pos + d) || IS_LMS(prev + d)))
+				break;
+		}
+		if (diff)
+		{
+			names++;
+			prev = pos;
+		}
+		sa[n1 + pos / 2] = names - 1;
+	}
+	for (int i = n - 1, j = n - 1; i >= n1; i--)
+		if (sa[i] >= 0)
+			sa[j--] = sa[i];
+
+	// sort the reduced string, recursing only if some names repeat
+	int *s1 = sa + n - n1;
+	if (names < n1)
+		suffixArrayIS(s1, sa, n1, names);
+	else
+		for (int i = 0; i < n1; i++)
+			sa[s1[i]] = i;
+
+	// map reduced positions back to LMS positions, then induce the full order
+	for (int i = 1, j = 0; i < n; i++)
+		if (IS_LMS(i))
+			s1[j++] = i;
+	for (int i = 0; i < n1; i++)
+		sa[i] = s1[sa[i]];
+	fill(sa + n1, sa + n, -1);
+
+	getBuckets(s, n, alphabet, bucket, true);
+	for (int i = n1 - 1; i >= 0; i--)
+	{
+		int j = sa[i];
+		sa[i] = -1;
+		sa[--bucket[s[j]]] = j;
+	}
+	induceSort(s, sa, n, alphabet, stype, bucket);
+
+	#undef IS_LMS
+}
+
+/*	Builds the suffix array of in[0..n) plus a unique end marker that sorts
+	before every byte. sa receives n + 1 entries; sa[0] is always the marker. */
+void suffixArray(const unsigned char *in, int n, vector<int> &sa)
+{
+	vector<int> s(n + 1);
+	for (int i = 0; i < n; i++)
+		s[i] = in[i] + 1;
+	s[n] = 0;
+
+	sa.assign(n + 1, 0);
+	suffixArrayIS(&s[0], &sa[0], n + 1, 257);
+}
+
+int bwtForward(const unsigned char *in, int n, unsigned char *out)
+{
+	vector<int> sa;
+	suffixArray(in, n, sa);
+
+	// the last column is the byte before each sorted suffix; the row whose
+	// suffix is the whole block would output the marker, so it is skipped
+	int primary = 0;
+	int j = 0;
+	for (int i = 0; i <= n; i++)
+	{
+		if (sa[i] == 0)
+			primary = i;
+		else
+			out[j++] = in[sa[i] - 1];
+	}
+	return primary;
+}
+
+bool bwtInverse(const unsigned char *in, int n, int primary, unsigned char *out)
+{
+	if (n == 0)
+		return true;
+	if (primary < 1 || primary > n)
+		return false;
+
+	// first row of each byte in the sorted first column; row 0 is the marker
+	int first[256] = { 0 };
+	for (int i = 0; i < n; i++)
+		first[in[i]]++;
+	int sum = 1;
+	for (int c = 0; c < 256; c++)
+	{
+		int count = first[c];
+		first[c] = sum;
+		sum += count;
+	}
+
+	// last-to-first mapping over the n + 1 rows, with the marker at primary
+	vector<int> next(n + 1);
+	for (int row = 0; row <= n; row++)
+	{
+		if (row == primary)
+			next[row] = 0;
+		else
+		{
+			unsigned char c = in[row < primary ? row : row - 1];
+			next[row] = first[c]++;
+		}
+	}
+
+	// walk backwards from the marker's row, emitting the last column
+	int row = 0;
+	for (int k = n - 1; k >= 0; k--)
+	{
+		if (row == primary)
+			return false;
+		out[k] = in[row < primary ? row : row - 1];
+		row = next[row];
+	}
+	return row == primary;
+}
+
+/* Appends the bijective base-2 digits of a zero run of the given length */
+void emitRun(int length, vector<unsigned short> &symbols)
+{
+	while (length > 0)
+	{
+		if (length & 1)
+		{
+			symbols.push_back(RUN_A);
+			length = (length - 1) / 2;
+		}
+		else
+		{
+			symbols.push_back(RUN_B);
+			length = (length - 2) / 2;
+		}
+	}
+}
+
+void mtfRleEncode(const unsigned char *in, int n, vector<unsigned short> &symbols)
+{
+	unsigned char order[256];
+	for (int i = 0; i < 256; i++)
+		order[i] = (unsigned char)i;
+
+	int run = 0;
+	for (int i = 0; i < n; i++)
+	{
+		unsigned char c = in[i];
+		if (order[0] == c)
+		{	// index 0, extend the current zero run
+			run++;
+			continue;
+		}
+
+		emitRun(run, symbols);
+		run = 0;
+
+		// find c and move it to the front
+		int j = 1;
+		unsigned char prev = order[0];
+		while (order[j] != c)
+		{
+			unsigned char t = order[j];
+			order[j] = prev;
+			prev = t;
+			j++;
+		}
+		order[j] = prev;
+		order[0] = c;
+		symbols.push_back((unsigned short)j);
+	}
+	emitRun(run, symbols);
+}
+
+bool mtfRleDecode(const unsigned short *symbols, size_t count, int maxlength, vector<unsigned char> &out)
+{
+	unsigned char order[256];
+	for (int i = 0; i < 256; i++)
+		order[i] = (unsigned char)i;
+
+	out.clear();
+	size_t i = 0;
+	while (i < count)
+	{
+		int s = symbols[i];
+		if (s == RUN_A || s == RUN_B)
+		{	// collect the whole run, least significant digit first
+			long long run = 0, weight = 1;
+			while (i < count && (symbols[i] == RUN_A || symbols[i] == RUN_B))
+			{
+				run += symbols[i] == RUN_A ? weight : 2 * weight;
+				weight <<= 1;
+				i++;
+				if (run > maxlength)
+					return false;
+			}
+			if ((long long)out.size() + run > maxlength)
+				return false;
+			out.insert(out.end(), size_t(run), order[0]);
+		}
+		else if (s >= 1 && s <= 255)
+		{
+			if ((int)out.size() >= maxlength)
+				return false;
+			unsigned char c = order[s];
+			memmove(order + 1, order, s);
+			order[0] = c;
+			out.push_back(c);
+			i++;
+		}
+		else
+			return false;
+	}
+	return true;
+}
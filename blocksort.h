@@ -0,0 +1,39 @@
+#pragma once
+#ifndef _BLOCKSORT_H
+#define _BLOCKSORT_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Block-sorting front end for the Huffman coder. A block of bytes
+	is put through the Burrows-Wheeler transform, then move-to-front coding,
+	which turns the BWT's long runs of equal bytes into runs of zeros, then
+	zero-run-length coding. The result is a sequence of wide symbols with a
+	much more skewed histogram than the input bytes had.
+
+	Symbols produced by mtfRleEncode:
+		1..255		a non-zero move-to-front index
+		RUN_A/B		one digit of a zero-run length, in bijective base 2
+*/
+
+#include <vector>
+#include <cstddef>
+
+const int RUN_A = 258;
+const int RUN_B = 259;
+
+/*	Writes the BWT of in[0..n) to out[0..n) and returns the primary index,
+	the row of the sorted rotations that holds the end-of-block marker. */
+int bwtForward(const unsigned char *in, int n, unsigned char *out);
+
+/* Undoes bwtForward. Returns false if primary isn't a valid row */
+bool bwtInverse(const unsigned char *in, int n, int primary, unsigned char *out);
+
+/* Move-to-front + zero-run coding of a BWT block, appended to symbols */
+void mtfRleEncode(const unsigned char *in, int n, std::vector<unsigned short> &symbols);
+
+/*	Undoes mtfRleEncode into out. Returns false if the symbols are malformed
+	or would expand past maxlength bytes. */
+bool mtfRleDecode(const unsigned short *symbols, size_t count, int maxlength, std::vector<unsigned char> &out);
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef _BOUNDEDQUEUE_H
+#define _BOUNDEDQUEUE_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: A fixed-capacity, thread-safe FIFO used to connect the stages of
+	the compression pipelines. push() blocks while the queue is full and pop()
+	blocks while it is empty, so a slow stage applies back-pressure to the
+	stages in front of it instead of letting buffers pile up.
+*/
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+template <typename T>
+class BoundedQueue
+{
+private:
+	std::deque<T> items_;
+	size_t capacity_;
+	bool closed_;
+	std::mutex lock_;
+	std::condition_variable notEmpty_;
+	std::condition_variable notFull_;
+
+public:
+	explicit BoundedQueue(size_t capacity)
+		: capacity_(capacity), closed_(false)
+	{
+	}
+
+	/* Adds item to the back of the queue. Returns false if the queue was closed */
+	bool push(const T &item)
+	{
+		std::unique_lock<std::mutex> guard(lock_);
+		while (items_.size() >= capacity_ && !closed_)
+			notFull_.wait(guard);
+		if (closed_)
+			return false;
+
+		items_.push_back(item);
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/* Removes the front item. Returns false once the queue is closed and drained */
+	bool pop(T &item)
+	{
+		std::unique_lock<std::mutex> guard(lock_);
+		while (items_.empty() && !closed_)
+			notEmpty_.wait(guard);
+		if (items_.empty())
+			return false;
+
+		item = items_.front();
+		items_.pop_front();
+		notFull_.notify_one();
+		return true;
+	}
+
+	/* Wakes every waiter; no more items may be pushed, queued items can still be popped */
+	void close()
+	{
+		std::lock_guard<std::mutex> guard(lock_);
+		closed_ = true;
+		notEmpty_.notify_all();
+		notFull_.notify_all();
+	}
+
+private:
+	// not copyable
+	BoundedQueue(const BoundedQueue&);
+	BoundedQueue& operator=(const BoundedQueue&);
+};
+
+#endif
@@ -0,0 +1,50 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of countBytes() declared in bytecounts.h.
+*/
+
+#include "bytecounts.h"
+#include <cstring>
+
+// bytes counted into 32-bit tables before they're added to the caller's counts
+const size_t COUNT_BATCH = 1 << 30;
+
+/*	Counts n bytes (n <= COUNT_BATCH) into counts, eight bytes per load with
+	consecutive bytes going to different tables. */
+inline void countBytesKernel(const unsigned char *p, size_t n, long long counts[256])
+{
+	unsigned int tables[4][256];
+	memset(tables, 0, sizeof(tables));
+
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		unsigned long long word;
+		memcpy(&word, p + i, 8);
+		tables[0][word & 0xFF]++;
+		tables[1][(word >> 8) & 0xFF]++;
+		tables[2][(word >> 16) & 0xFF]++;
+		tables[3][(word >> 24) & 0xFF]++;
+		tables[0][(word >> 32) & 0xFF]++;
+		tables[1][(word >> 40) & 0xFF]++;
+		tables[2][(word >> 48) & 0xFF]++;
+		tables[3][word >> 56]++;
+	}
+	for (; i < n; i++)
+		tables[0][p[i]]++;
+
+	for (int b = 0; b < 256; b++)
+		counts[b] += (long long)tables[0][b] + tables[1][b] + tables[2][b] + tables[3][b];
+}
+
+void countBytes(const unsigned char *data, size_t n, long long counts[256])
+{
+	while (n > 0)
+	{
+		size_t batch = n < COUNT_BATCH ? n : COUNT_BATCH;
+		countBytesKernel(data, batch, counts);
+		data += batch;
+		n -= batch;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef _BYTECOUNTS_H
+#define _BYTECOUNTS_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Counting byte frequencies, the first pass of every compression.
+	A loop that increments one table stalls whenever neighbouring bytes are
+	equal, since each increment has to wait for the previous store to the
+	same counter. Spreading the counts over four tables and summing them at
+	the end keeps runs of equal bytes from serializing.
+*/
+
+#include <cstddef>
+
+/* Adds the number of times each byte value occurs in data[0..n) to counts */
+void countBytes(const unsigned char *data, size_t n, long long counts[256]);
+
+#endif
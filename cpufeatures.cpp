@@ -0,0 +1,94 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of cpuFeatures() declared in cpufeatures.h.
+*/
+
+#include "cpufeatures.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(HUFF_X64) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(HUFF_X64)
+#include <cpuid.h>
+#endif
+
+using namespace std;
+
+#ifdef HUFF_X64
+/* Runs cpuid for leaf and subleaf; all zeros if the leaf isn't supported */
+void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+	regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if ((unsigned int)info[0] < leaf)
+		return;
+	__cpuidex(info, int(leaf), int(subleaf));
+	memcpy(regs, info, sizeof(info));
+#else
+	if (__get_cpuid_max(0, NULL) < leaf)
+		return;
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* The register states the OS saves on a context switch (XCR0) */
+unsigned long long xgetbv0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif
+
+/* Reads the host's features, honouring HUFF_CPU=baseline */
+CpuFeatures detectFeatures()
+{
+	CpuFeatures features;
+	const char *override = getenv("HUFF_CPU");
+	if (override != NULL && strcmp(override, "baseline") == 0)
+		return features;
+
+#ifdef HUFF_X64
+	unsigned int leaf1[4], leaf7[4];
+	cpuid(1, 0, leaf1);
+	cpuid(7, 0, leaf7);
+
+	features.sse42 = ((leaf1[2] >> 20) & 1) != 0;
+	features.popcnt = ((leaf1[2] >> 23) & 1) != 0;
+	features.bmi1 = ((leaf7[1] >> 3) & 1) != 0;
+	features.bmi2 = ((leaf7[1] >> 8) & 1) != 0;
+
+	// AVX2 also needs the OS to save the ymm registers (xmm and ymm bits of XCR0)
+	bool osxsave = ((leaf1[2] >> 27) & 1) != 0;
+	bool avx = ((leaf1[2] >> 28) & 1) != 0;
+	if (osxsave && avx && (xgetbv0() & 6) == 6)
+		features.avx2 = ((leaf7[1] >> 5) & 1) != 0;
+#endif
+	return features;
+}
+
+string CpuFeatures::describe() const
+{
+	string names;
+	if (sse42) names += " sse4.2";
+	if (popcnt) names += " popcnt";
+	if (bmi1) names += " bmi1";
+	if (bmi2) names += " bmi2";
+	if (avx2) names += " avx2";
+	return names.empty() ? "baseline" : names.substr(1);
+}
+
+const CpuFeatures& cpuFeatures()
+{
+	static const CpuFeatures features = detectFeatures();
+	return features;
+}
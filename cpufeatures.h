@@ -0,0 +1,67 @@
+#pragma once
+#ifndef _CPUFEATURES_H
+#define _CPUFEATURES_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Runtime detection of the x86-64 extensions the kernels can use,
+	so one build picks the fastest kernel each host supports.
+
+	A kernel is written once, as inline code, and then instantiated a second
+	time inside a wrapper function marked HUFF_TARGET(isa). The wrapper is
+	compiled for the extension, everything it calls is inlined into it, and
+	it is only reached after cpuFeatures() has confirmed the host runs that
+	extension. Nothing outside a wrapper is compiled for more than the
+	baseline instruction set, so older hosts never see an instruction they
+	can't execute.
+
+	Only kernels that measured faster have a second build:
+		CRC-32C		SSE4.2 crc32, about 3.7x the table kernel
+		encoding	BMI2, about 15% faster from shlx in the accumulator
+	The decode kernel, the byte counts and the delta/shuffle filters were
+	tried with BMI2 and AVX2 builds, and they were no faster than baseline.
+
+	MSVC has no per-function target attribute, so there the encoder wrapper
+	compiles to the baseline. The CRC kernel uses intrinsics, which MSVC
+	accepts in any function.
+
+	Setting the environment variable HUFF_CPU=baseline turns every extension
+	off, which is how the fallback kernels are tested on newer hosts.
+*/
+
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HUFF_X64
+#endif
+
+#if defined(HUFF_X64) && (defined(__GNUC__) || defined(__clang__))
+#define HUFF_TARGET(isa) __attribute__((target(isa), flatten))
+#else
+#define HUFF_TARGET(isa)
+#endif
+
+// Extensions present on this host and enabled by the operating system
+class CpuFeatures
+{
+public:
+	bool sse42;		// crc32
+	bool popcnt;
+	bool bmi1;		// andn, blsr, tzcnt
+	bool bmi2;		// shlx, shrx, bzhi, pext
+	bool avx2;		// 256-bit integer vectors, with the OS saving ymm state
+
+	CpuFeatures()
+		: sse42(false), popcnt(false), bmi1(false), bmi2(false), avx2(false)
+	{
+	}
+
+	/* Names of the enabled extensions, or "baseline" */
+	std::string describe() const;
+};
+
+/* Features of the host, detected on first use */
+const CpuFeatures& cpuFeatures();
+
+#endif
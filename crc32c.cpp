@@ -0,0 +1,90 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of crc32c() declared in crc32c.h.
+*/
+
+#include "crc32c.h"
+#include <cstring>
+#include "cpufeatures.h"
+
+#ifdef HUFF_X64
+#include <nmmintrin.h>
+#endif
+
+const unsigned int CRC32C_POLY = 0x82F63B78;	// reversed Castagnoli polynomial
+
+// table[k][b] is the crc of byte b followed by k zero bytes
+class Crc32cTable
+{
+public:
+	unsigned int table[8][256];
+
+	Crc32cTable()
+	{
+		for (unsigned int b = 0; b < 256; b++)
+		{
+			unsigned int crc = b;
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+			table[0][b] = crc;
+		}
+		for (unsigned int b = 0; b < 256; b++)
+			for (int k = 1; k < 8; k++)
+				table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+	}
+};
+
+// built during static initialization, before any thread can use it
+static const Crc32cTable crcTable;
+
+/* Table driven crc of n bytes, eight bytes per step */
+unsigned int crc32cSlicing(unsigned int crc, const unsigned char *p, size_t n)
+{
+	const unsigned int (*t)[256] = crcTable.table;
+	while (n >= 8)
+	{
+		unsigned int lo, hi;
+		memcpy(&lo, p, 4);		// little-endian loads
+		memcpy(&hi, p + 4, 4);
+		lo ^= crc;
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+			  t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+		p += 8;
+		n -= 8;
+	}
+	while (n-- > 0)
+		crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+	return crc;
+}
+
+#ifdef HUFF_X64
+/* Hardware crc, eight bytes per instruction; only called when the host has SSE4.2 */
+HUFF_TARGET("sse4.2") unsigned int crc32cSse42(unsigned int crc, const unsigned char *p, size_t n)
+{
+	unsigned long long crc64 = crc;
+	while (n >= 8)
+	{
+		unsigned long long word;
+		memcpy(&word, p, 8);
+		crc64 = _mm_crc32_u64(crc64, word);
+		p += 8;
+		n -= 8;
+	}
+	crc = (unsigned int)crc64;
+	while (n-- > 0)
+		crc = _mm_crc32_u8(crc, *p++);
+	return crc;
+}
+#endif
+
+unsigned int crc32c(unsigned int crc, const void *data, size_t n)
+{
+	const unsigned char *p = (const unsigned char*)data;
+	crc = ~crc;
+#ifdef HUFF_X64
+	if (cpuFeatures().sse42)
+		return ~crc32cSse42(crc, p, n);
+#endif
+	return ~crc32cSlicing(crc, p, n);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#ifndef _CRC32C_H
+#define _CRC32C_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: CRC-32C (Castagnoli) checksums for the blocks of a .hf file.
+	Uses the SSE4.2 crc32 instruction when the host has it and a
+	slicing-by-8 table otherwise; both give the same result.
+*/
+
+#include <cstddef>
+
+/* Extends crc (0 for a new checksum) with n bytes of data */
+unsigned int crc32c(unsigned int crc, const void *data, size_t n);
+
+#endif
@@ -0,0 +1,149 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of the filters declared in filters.h. Each filter
+	is a template on the element type or width, so the inner loops have fixed
+	strides the compiler can unroll and vectorize.
+*/
+
+#include "filters.h"
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+// elements are read and written with memcpy; records are little-endian,
+// the same as every host the project targets
+template <typename T>
+inline T loadElement(const unsigned char *p)
+{
+	T v;
+	memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+template <typename T>
+inline void storeElement(unsigned char *p, T v)
+{
+	memcpy(p, &v, sizeof(T));
+}
+
+/* out[i] = in[i] - in[i-1], wrapping, for count elements of type T */
+template <typename T>
+void deltaEncode(const unsigned char *in, size_t count, unsigned char *out)
+{
+	T prev = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		T v = loadElement<T>(in + i * sizeof(T));
+		storeElement<T>(out + i * sizeof(T), T(v - prev));
+		prev = v;
+	}
+}
+
+/* Running sum that undoes deltaEncode */
+template <typename T>
+void deltaDecode(const unsigned char *in, size_t count, unsigned char *out)
+{
+	T sum = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		sum = T(sum + loadElement<T>(in + i * sizeof(T)));
+		storeElement<T>(out + i * sizeof(T), sum);
+	}
+}
+
+/* Byte b of element i moves to plane b, position i */
+template <int Width>
+void shuffle(const unsigned char *in, size_t count, unsigned char *out)
+{
+	for (int b = 0; b < Width; b++)
+	{
+		unsigned char *plane = out + b * count;
+		for (size_t i = 0; i < count; i++)
+			plane[i] = in[i * Width + b];
+	}
+}
+
+template <int Width>
+void unshuffle(const unsigned char *in, size_t count, unsigned char *out)
+{
+	for (int b = 0; b < Width; b++)
+	{
+		const unsigned char *plane = in + b * count;
+		for (size_t i = 0; i < count; i++)
+			out[i * Width + b] = plane[i];
+	}
+}
+
+template <typename T>
+void applyFiltersT(int filters, const unsigned char *in, size_t count, unsigned char *out)
+{
+	const size_t bytes = count * sizeof(T);
+	if ((filters & FILTER_DELTA) && (filters & FILTER_SHUFFLE))
+	{
+		vector<unsigned char> tmp(bytes);
+		deltaEncode<T>(in, count, tmp.empty() ? NULL : &tmp[0]);
+		shuffle<sizeof(T)>(tmp.empty() ? NULL : &tmp[0], count, out);
+	}
+	else if (filters & FILTER_DELTA)
+		deltaEncode<T>(in, count, out);
+	else if (filters & FILTER_SHUFFLE)
+		shuffle<sizeof(T)>(in, count, out);
+	else
+		memcpy(out, in, bytes);
+}
+
+template <typename T>
+void removeFiltersT(int filters, const unsigned char *in, size_t count, unsigned char *out)
+{
+	const size_t bytes = count * sizeof(T);
+	if ((filters & FILTER_DELTA) && (filters & FILTER_SHUFFLE))
+	{
+		vector<unsigned char> tmp(bytes);
+		unshuffle<sizeof(T)>(in, count, tmp.empty() ? NULL : &tmp[0]);
+		deltaDecode<T>(tmp.empty() ? NULL : &tmp[0], count, out);
+	}
+	else if (filters & FILTER_DELTA)
+		deltaDecode<T>(in, count, out);
+	else if (filters & FILTER_SHUFFLE)
+		unshuffle<sizeof(T)>(in, count, out);
+	else
+		memcpy(out, in, bytes);
+}
+
+bool validFilterWidth(int width)
+{
+	return width == 2 || width == 4 || width == 8;
+}
+
+void applyFilters(int filters, int width, const unsigned char *in, size_t n, unsigned char *out)
+{
+	size_t count = validFilterWidth(width) ? n / width : 0;
+	switch (width)
+	{
+	case 2: applyFiltersT<unsigned short>(filters, in, count, out); break;
+	case 4: applyFiltersT<unsigned int>(filters, in, count, out); break;
+	case 8: applyFiltersT<unsigned long long>(filters, in, count, out); break;
+	default: count = 0; break;
+	}
+
+	// partial element at the end is stored as is
+	size_t whole = count * width;
+	memcpy(out + whole, in + whole, n - whole);
+}
+
+void removeFilters(int filters, int width, const unsigned char *in, size_t n, unsigned char *out)
+{
+	size_t count = validFilterWidth(width) ? n / width : 0;
+	switch (width)
+	{
+	case 2: removeFiltersT<unsigned short>(filters, in, count, out); break;
+	case 4: removeFiltersT<unsigned int>(filters, in, count, out); break;
+	case 8: removeFiltersT<unsigned long long>(filters, in, count, out); break;
+	default: count = 0; break;
+	}
+
+	size_t whole = count * width;
+	memcpy(out + whole, in + whole, n - whole);
+}
@@ -0,0 +1,42 @@
+#pragma once
+#ifndef _FILTERS_H
+#define _FILTERS_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Reversible filters for arrays of fixed-width binary records.
+	Byte-level statistics of such data are nearly flat, so the filters turn
+	it into something the Huffman stage can use:
+
+		FILTER_DELTA	replaces each little-endian integer with its difference
+						from the previous one, so slowly changing counters and
+						timestamps become runs of small values
+		FILTER_SHUFFLE	groups byte 0 of every element, then byte 1, ..., so
+						the mostly-constant high bytes end up next to each other
+
+	Delta is applied first, then shuffle. Trailing bytes that don't make up a
+	whole element are passed through unchanged. Elements may be 2, 4 or 8
+	bytes wide.
+*/
+
+#include <cstddef>
+
+enum FilterFlags
+{
+	FILTER_DELTA = 0x01,
+	FILTER_SHUFFLE = 0x02
+};
+
+const int FILTER_ALL = FILTER_DELTA | FILTER_SHUFFLE;
+
+/* True if width is an element size the filters support */
+bool validFilterWidth(int width);
+
+/* Filters in[0..n) into out[0..n) */
+void applyFilters(int filters, int width, const unsigned char *in, size_t n, unsigned char *out);
+
+/* Undoes applyFilters */
+void removeFilters(int filters, int width, const unsigned char *in, size_t n, unsigned char *out);
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef _HUFFARCHIVE_H
+#define _HUFFARCHIVE_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Layout of .hfa archives, which pack many files into one container
+	so a directory of small files costs one open and one header instead of
+	one of each per file.
+
+		archive header
+			32 bits		HA_MAGIC
+			8 bits		HA_VERSION
+			8 bits		flags (ArchiveFlags)
+			[32 bits length, shared tree header
+			 zero padded to a byte]		if HA_SHARED_TABLE
+		members, back to back, each byte aligned and zero padded
+			[tree header]				unless HA_SHARED_TABLE
+			codes, PSEUDO_EOF
+		directory
+			32 bits		member count
+			per member
+				16 bits		name length, then the name
+				64 bits		offset of the member from the start of the archive
+				64 bits		compressed bytes
+				64 bits		original bytes
+				32 bits		CRC-32C of the original bytes
+		trailer
+			64 bits		offset of the directory
+			32 bits		HA_MAGIC
+
+	A reader seeks to the trailer, loads the directory, and can then extract
+	any member without touching the others. Members are coded over the same
+	symbols as the block format, and since their lengths are in the
+	directory they are decoded with a counted loop.
+
+	Member names are bare file names: no '/', '\\', "..", or drive prefix,
+	so extracting everything into a directory can't write outside it. Names
+	are unique within an archive, so files of the same name from different
+	directories can't be packed together.
+	Members are at most HF_MAX_BLOCK_SIZE bytes, since each is decoded
+	whole. Readers reject directories that break either rule, or whose
+	members don't fit before the directory. Only an empty member may take
+	no bytes: under a shared table that codes nothing but PSEUDO_EOF, its
+	code is 0 bits long.
+*/
+
+#include <string>
+
+const unsigned int HA_MAGIC = 0xFF484641;	// "\xFFHFA"
+const int HA_VERSION = 1;
+
+// bytes in the archive trailer
+const int HA_TRAILER_SIZE = 12;
+
+enum ArchiveFlags
+{
+	HA_SHARED_TABLE = 0x01		// one tree, in the archive header, codes every member
+};
+
+// One member's entry in the archive directory
+class ArchiveEntry
+{
+public:
+	std::string name;
+	unsigned long long offset;	// from the start of the archive
+	unsigned long long size;	// compressed bytes
+	unsigned long long length;	// original bytes
+	unsigned int crc;			// CRC-32C of the original bytes
+
+	ArchiveEntry()
+		: offset(0), size(0), length(0), crc(0)
+	{
+	}
+};
+
+#endif
@@ -0,0 +1,404 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of HuffDaemon and daemonRequest() declared in
+	huffdaemon.h.
+*/
+
+#include "huffdaemon.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include "hufftree.h"
+#include "boundedqueue.h"
+#include "tablecache.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// how often blocked waits look for a stop request, in milliseconds
+const int HD_POLL_MS = 200;
+
+DaemonStats::DaemonStats()
+	: connections(0), requests(0), failures(0), bytesin(0), bytesout(0), busymicros(0), queued(0)
+{
+	for (int b = 0; b < HD_LATENCY_BUCKETS; b++)
+		latency[b] = 0;
+}
+
+void DaemonStats::record(long long micros, size_t in, size_t out, bool ok)
+{
+	requests++;
+	if (!ok)
+		failures++;
+	bytesin += in;
+	bytesout += out;
+	busymicros += micros;
+
+	int b = 0;
+	while (b < HD_LATENCY_BUCKETS - 1 && (1LL << b) <= micros)
+		b++;
+	latency[b]++;
+}
+
+long long DaemonStats::percentile(double fraction) const
+{
+	long long total = 0;
+	for (int b = 0; b < HD_LATENCY_BUCKETS; b++)
+		total += latency[b];
+	if (total == 0)
+		return 0;
+
+	long long seen = 0;
+	for (int b = 0; b < HD_LATENCY_BUCKETS; b++)
+	{
+		seen += latency[b];
+		if (seen >= fraction * total)
+			return 1LL << b;
+	}
+	return 1LL << (HD_LATENCY_BUCKETS - 1);
+}
+
+string DaemonStats::report() const
+{
+	ostringstream out;
+	TableCache &cache = TableCache::shared();
+	out << "connections " << connections << "\n"
+		<< "queued " << queued << "\n"
+		<< "requests " << requests << "\n"
+		<< "failures " << failures << "\n"
+		<< "bytes_in " << bytesin << "\n"
+		<< "bytes_out " << bytesout << "\n"
+		<< "busy_us " << busymicros << "\n"
+		<< "latency_p50_us " << percentile(0.5) << "\n"
+		<< "latency_p99_us " << percentile(0.99) << "\n"
+		<< "table_cache_hits " << cache.hits() << "\n"
+		<< "table_cache_misses " << cache.misses() << "\n";
+	return out.str();
+}
+
+HuffDaemon::HuffDaemon(const string &socketPath, const HuffOptions &options, int workers)
+	: socketPath_(socketPath), options_(options), workers_(workers)
+{
+	options_.sharedtables = true;
+	if (workers_ <= 0)
+		workers_ = max(1u, thread::hardware_concurrency());
+}
+
+void HuffDaemon::train(const vector<string> &fileNames)
+{
+	vector<unsigned char> compressed;
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		ifstream infile(fileNames[i].c_str(), ios::binary);
+		vector<unsigned char> data((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
+		HuffTree::huff(data, compressed, options_);
+	}
+}
+
+/* Codes one request into response and returns its DaemonStatus */
+int HuffDaemon::handle(int op, const vector<unsigned char> &request, vector<unsigned char> &response)
+{
+	string message;
+	int status = HD_OK;
+	switch (op)
+	{
+	case HD_COMPRESS:
+		if (!HuffTree::huff(request, response, options_))
+		{
+			status = HD_FAILED;
+			message = "compression failed";
+		}
+		break;
+	case HD_DECOMPRESS:
+		if (!HuffTree::unhuff(request, response))
+		{
+			status = HD_FAILED;
+			message = "not a valid compressed payload";
+		}
+		break;
+	case HD_STATS:
+		message = stats_.report();
+		break;
+	default:
+		status = HD_REFUSED;
+		message = "unknown operation";
+		break;
+	}
+
+	if (status != HD_OK || op == HD_STATS)
+		response.assign(message.begin(), message.end());
+	return status;
+}
+
+#ifndef _WIN32
+
+// set from the signal handler; every blocking wait in the daemon checks it
+static volatile sig_atomic_t stopRequested = 0;
+
+void onStopSignal(int)
+{
+	stopRequested = 1;
+}
+
+typedef chrono::steady_clock Clock;
+
+/*	Waits until fd is ready for events. False once deadline passes, the
+	daemon is asked to stop, or poll fails */
+bool waitReady(int fd, short events, Clock::time_point deadline)
+{
+	for (;;)
+	{
+		if (stopRequested)
+			return false;
+		long long left = chrono::duration_cast<chrono::milliseconds>(deadline - Clock::now()).count();
+		if (left <= 0)
+			return false;
+		pollfd waiting = { fd, events, 0 };
+		int ready = poll(&waiting, 1, int(min<long long>(left, HD_POLL_MS)));
+		if (ready > 0)
+			return true;	// includes hang-ups and errors, which the read or write then reports
+		if (ready < 0 && errno != EINTR)
+			return false;
+	}
+}
+
+/* Reads exactly n bytes by deadline. False at end of stream, on an error, or when time runs out */
+bool readFull(int fd, void *buf, size_t n, Clock::time_point deadline)
+{
+	char *p = (char*)buf;
+	while (n > 0)
+	{
+		if (!waitReady(fd, POLLIN, deadline))
+			return false;
+		ssize_t got = read(fd, p, n);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return false;
+		p += got;
+		n -= size_t(got);
+	}
+	return true;
+}
+
+bool writeFull(int fd, const void *buf, size_t n, Clock::time_point deadline)
+{
+	const char *p = (const char*)buf;
+	while (n > 0)
+	{
+		if (!waitReady(fd, POLLOUT, deadline))
+			return false;
+		ssize_t put = write(fd, p, n);
+		if (put < 0 && errno == EINTR)
+			continue;
+		if (put <= 0)
+			return false;
+		p += put;
+		n -= size_t(put);
+	}
+	return true;
+}
+
+/*	Sends a request or response: its code, the payload length, then the
+	payload. False, sending nothing, if the length doesn't fit its 32 bits */
+bool sendMessage(int fd, int code, const vector<unsigned char> &payload, Clock::time_point deadline)
+{
+	if (payload.size() > HD_MAX_RESPONSE)
+		return false;
+	unsigned int length = unsigned(payload.size());
+	unsigned char header[5] = { (unsigned char)code, (unsigned char)(length >> 24), (unsigned char)(length >> 16),
+		(unsigned char)(length >> 8), (unsigned char)length };
+	return writeFull(fd, header, sizeof(header), deadline) &&
+		(payload.empty() || writeFull(fd, &payload[0], payload.size(), deadline));
+}
+
+/* Reads the code and length that start a message */
+bool receiveHeader(int fd, int &code, unsigned int &length, Clock::time_point deadline)
+{
+	unsigned char header[5];
+	if (!readFull(fd, header, sizeof(header), deadline))
+		return false;
+	code = header[0];
+	length = (unsigned(header[1]) << 24) | (unsigned(header[2]) << 16) | (unsigned(header[3]) << 8) | header[4];
+	return true;
+}
+
+/*	Answers requests on fd until the client hangs up, the connection idles
+	out, or the daemon stops */
+void HuffDaemon::serveConnection(int fd)
+{
+	vector<unsigned char> request, response;
+	Clock::time_point idlesince = Clock::now();
+	for (;;)
+	{
+		pollfd waiting = { fd, POLLIN, 0 };
+		int ready = poll(&waiting, 1, HD_POLL_MS);
+		if (stopRequested)
+			return;
+		if (ready <= 0)
+		{	// an idle client gives up its worker after HD_IDLE_MS, or at once if others are waiting for one
+			if (stats_.queued > 0 || Clock::now() - idlesince >= chrono::milliseconds(HD_IDLE_MS))
+				return;
+			continue;
+		}
+
+		int op;
+		unsigned int length;
+		Clock::time_point deadline = Clock::now() + chrono::milliseconds(HD_TRANSFER_MS);
+		if (!receiveHeader(fd, op, length, deadline))
+			return;
+		if (length > HD_MAX_PAYLOAD)
+		{	// can't skip what we won't read, so the connection ends here
+			string message = "payload too large";
+			sendMessage(fd, HD_REFUSED, vector<unsigned char>(message.begin(), message.end()), deadline);
+			return;
+		}
+		request.resize(length);
+		if (length > 0 && !readFull(fd, &request[0], length, deadline))
+			return;
+
+		Clock::time_point start = Clock::now();
+		response.clear();
+		int status = handle(op, request, response);
+		if (response.size() > HD_MAX_RESPONSE)
+		{
+			string message = "response too large";
+			response.assign(message.begin(), message.end());
+			status = HD_FAILED;
+		}
+		long long micros = chrono::duration_cast<chrono::microseconds>(Clock::now() - start).count();
+		stats_.record(micros, request.size(), response.size(), status == HD_OK);
+
+		if (!sendMessage(fd, status, response, Clock::now() + chrono::milliseconds(HD_TRANSFER_MS)))
+			return;
+		idlesince = Clock::now();
+	}
+}
+
+bool HuffDaemon::run()
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath_.size() >= sizeof(address.sun_path))
+		return false;
+	strcpy(address.sun_path, socketPath_.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		return false;
+	unlink(socketPath_.c_str());	// left behind by a daemon that didn't shut down
+	if (bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0)
+	{
+		close(listener);
+		return false;
+	}
+
+	stopRequested = 0;
+	signal(SIGPIPE, SIG_IGN);	// a client hanging up mid-response only ends its connection
+	signal(SIGINT, onStopSignal);
+	signal(SIGTERM, onStopSignal);
+
+	BoundedQueue<int> pending(size_t(workers_) * HD_QUEUE_PER_WORKER);
+	vector<thread> pool;
+	for (int i = 0; i < workers_; i++)
+		pool.push_back(thread([&]()
+		{
+			int fd;
+			while (!stopRequested && pending.pop(fd))
+			{
+				stats_.queued--;
+				serveConnection(fd);
+				close(fd);
+			}
+			pending.close();	// releases the acceptor if it's waiting for room
+		}));
+
+	while (!stopRequested)
+	{
+		pollfd waiting = { listener, POLLIN, 0 };
+		if (poll(&waiting, 1, HD_POLL_MS) <= 0)
+			continue;
+		int fd = accept(listener, NULL, NULL);
+		if (fd < 0)
+			continue;
+
+		stats_.connections++;
+		stats_.queued++;
+		if (!pending.push(fd))	// waits while every worker is busy and the queue is full
+		{
+			stats_.queued--;
+			close(fd);
+		}
+	}
+
+	pending.close();
+	for (size_t i = 0; i < pool.size(); i++)
+		pool[i].join();
+	int fd;
+	while (pending.pop(fd))
+		close(fd);
+
+	close(listener);
+	unlink(socketPath_.c_str());
+	return true;
+}
+
+bool daemonRequest(const string &socketPath, int op, const vector<unsigned char> &payload,
+	int &status, vector<unsigned char> &response)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path))
+		return false;
+	strcpy(address.sun_path, socketPath.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return false;
+
+	// coding a large payload can take a while, so the client waits as long as it takes
+	const Clock::time_point forever = Clock::time_point::max();
+	unsigned int length = 0;
+	bool ok = connect(fd, (sockaddr*)&address, sizeof(address)) == 0 &&
+		sendMessage(fd, op, payload, forever) && receiveHeader(fd, status, length, forever);
+	if (ok)
+	{
+		response.resize(length);
+		ok = length == 0 || readFull(fd, &response[0], length, forever);
+	}
+	close(fd);
+	return ok;
+}
+
+#else
+
+void HuffDaemon::serveConnection(int)
+{
+}
+
+bool HuffDaemon::run()
+{
+	return false;
+}
+
+bool daemonRequest(const string&, int, const vector<unsigned char>&, int&, vector<unsigned char>&)
+{
+	return false;
+}
+
+#endif
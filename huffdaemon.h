@@ -0,0 +1,143 @@
+#pragma once
+#ifndef _HUFFDAEMON_H
+#define _HUFFDAEMON_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: A long-running compression service on a Unix domain socket, so
+	local producers share one process whose threads and code tables are
+	already warm instead of paying for a process start per payload.
+
+	Each connection carries any number of requests, answered in order:
+
+		request
+			8 bits		operation (DaemonOp)
+			32 bits		payload length, at most HD_MAX_PAYLOAD
+			payload
+		response
+			8 bits		status (DaemonStatus)
+			32 bits		payload length
+			payload		compressed or decompressed data, the counters as
+						"name value" lines for HD_STATS, or an error message
+
+	Compressed payloads are block format files (huffformat.h) written with
+	the daemon's options plus HF_TABLEREF, so tables come from the shared
+	TableCache. Decompression accepts either format. Tables can be warmed at
+	start-up by compressing sample files.
+
+	Accepted connections wait in a bounded queue for a worker, and each
+	worker serves one connection at a time. Once the queue is full the
+	acceptor stops accepting, so new clients wait in the socket's listen
+	backlog instead of piling up inside the daemon. A connection with no
+	request in progress is closed after HD_IDLE_MS, or as soon as another
+	connection is waiting for a worker, so idle clients can't hold every
+	worker; they reconnect for their next request. A request that hasn't
+	fully arrived, or a response the client hasn't taken, within
+	HD_TRANSFER_MS also ends its connection.
+
+	Only available where Unix domain sockets are (not _WIN32).
+*/
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "huffformat.h"
+
+// payloads larger than this are refused, and the connection closed
+const unsigned int HD_MAX_PAYLOAD = 256 << 20;
+
+// longest response the 32-bit length can describe; a larger one is answered with HD_FAILED
+const unsigned long long HD_MAX_RESPONSE = 0xFFFFFFFFull;
+
+// milliseconds a connection may sit between requests before the daemon closes it
+const int HD_IDLE_MS = 10000;
+
+// milliseconds a request may take to arrive once it has started, or a response to be taken
+const int HD_TRANSFER_MS = 30000;
+
+// connections queued for a worker, per worker
+const int HD_QUEUE_PER_WORKER = 4;
+
+// buckets of the latency histogram; bucket b counts requests under 2^b microseconds
+const int HD_LATENCY_BUCKETS = 32;
+
+enum DaemonOp
+{
+	HD_COMPRESS = 1,
+	HD_DECOMPRESS = 2,
+	HD_STATS = 3
+};
+
+enum DaemonStatus
+{
+	HD_OK = 0,
+	HD_FAILED = 1,		// the payload couldn't be coded, or its result is too large to send
+	HD_REFUSED = 2		// unknown operation or payload too large
+};
+
+// Counters shared by every worker
+class DaemonStats
+{
+public:
+	std::atomic<long long> connections;
+	std::atomic<long long> requests;
+	std::atomic<long long> failures;
+	std::atomic<long long> bytesin;
+	std::atomic<long long> bytesout;
+	std::atomic<long long> busymicros;		// time spent coding
+	std::atomic<int> queued;				// connections waiting for a worker
+	std::atomic<long long> latency[HD_LATENCY_BUCKETS];
+
+	DaemonStats();
+
+	/* Records one request that took micros microseconds */
+	void record(long long micros, size_t in, size_t out, bool ok);
+
+	/* Upper bound, in microseconds, of the latency below which fraction of requests fell */
+	long long percentile(double fraction) const;
+
+	/* Every counter as "name value" lines */
+	std::string report() const;
+
+private:
+	// not copyable
+	DaemonStats(const DaemonStats&);
+	DaemonStats& operator=(const DaemonStats&);
+};
+
+class HuffDaemon
+{
+private:
+	std::string socketPath_;
+	HuffOptions options_;
+	int workers_;
+	DaemonStats stats_;
+
+public:
+	/* Serves on socketPath with workers threads (0 for one per core), compressing with options */
+	HuffDaemon(const std::string &socketPath, const HuffOptions &options, int workers);
+
+	/* Compresses each file once, filling the table cache before any client connects */
+	void train(const std::vector<std::string> &fileNames);
+
+	/* Accepts connections until SIGINT or SIGTERM. False if the socket can't be opened */
+	bool run();
+
+	const DaemonStats& stats() const { return stats_; }
+
+private:
+	void serveConnection(int fd);
+	int handle(int op, const std::vector<unsigned char> &request, std::vector<unsigned char> &response);
+
+	// not copyable
+	HuffDaemon(const HuffDaemon&);
+	HuffDaemon& operator=(const HuffDaemon&);
+};
+
+/*	Sends one request to the daemon on socketPath and waits for the answer.
+	False if the daemon can't be reached; otherwise status is its answer. */
+bool daemonRequest(const std::string &socketPath, int op, const std::vector<unsigned char> &payload,
+	int &status, std::vector<unsigned char> &response);
+
+#endif
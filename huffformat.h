@@ -0,0 +1,225 @@
+#pragma once
+#ifndef _HUFFFORMAT_H
+#define _HUFFFORMAT_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Layout of the block-structured .hf format and the options that
+	select it.
+
+	The original format is a tree header followed by one stream of codes.
+	The block format wraps optional transforms around the same coder:
+
+		file header
+			32 bits		HF_MAGIC
+			8 bits		HF_VERSION
+			8 bits		flags (HuffFlags)
+			32 bits		block size: the most bytes any block decodes to
+			[8 bits filters, 8 bits element width]		if HF_FILTER
+			[64 bits original file length]				if HF_LENGTHS
+			[8 bits LZ77 level, for information only]	if HF_LZ77
+		blocks, repeated
+			32 bits		payload length in bytes, 0 ends the file
+			[32 bits decoded length]				if HF_CHECKSUM or HF_LENGTHS
+			[32 bits payload CRC-32C,
+			 32 bits decoded data CRC-32C]			if HF_CHECKSUM
+			[32 bits symbols before PSEUDO_EOF]		if HF_LENGTHS
+			[32 bits table source]					if HF_TABLEREF
+			payload		byte aligned, zero padded
+				[32 bits primary index]		if HF_BLOCKSORT
+				tree header					same layout as the original format,
+											absent if the table source is a block
+				[distance tree header]		if HF_LZ77
+				codes, PSEUDO_EOF
+				[distance codes, PSEUDO_EOF,
+				 zero padding to a byte,
+				 extra bits of every match]	if HF_LZ77
+
+	With HF_LENGTHS, a decoder can size its buffers and the output file up
+	front and decode each block with a counted loop. PSEUDO_EOF is still
+	written, so the lengths are only a shortcut.
+
+	With HF_LZ77, the codes are the literal/length symbols of lz77.h, and
+	the symbol count of HF_LENGTHS counts those. The table source only
+	applies to the literal/length tree; every block stores its distance
+	tree. HF_LZ77 and HF_BLOCKSORT can't be combined.
+
+	With HF_TABLEREF, a block whose statistics match a recent block's can
+	reuse its tree instead of storing its own. The table source is then the
+	index of that earlier block, which must be one of the last HF_TABLE_WINDOW
+	blocks that stored a tree; HF_INLINE_TABLE means the tree is in the payload.
+
+	Apart from table sources, blocks are independent: a damaged block can be
+	detected from its checksums and skipped without losing the blocks after
+	it.
+
+	Original-format files always begin with a 0 bit (root is an internal node)
+	or with the leaf for PSEUDO_EOF, so they can never start with 0xFF.
+*/
+
+#include <vector>
+#include <iosfwd>
+
+const unsigned int HF_MAGIC = 0xFF484632;	// "\xFFHF2"
+const int HF_VERSION = 1;
+
+// optional stages, stored in the flags byte of the file header
+enum HuffFlags
+{
+	HF_BLOCKSORT = 0x01,	// BWT + move-to-front + zero-run coding
+	HF_FILTER = 0x02,		// binary record filters from filters.h, before everything else
+	HF_CHECKSUM = 0x04,		// per-block lengths and checksums
+	HF_TABLEREF = 0x08,		// blocks may reuse an earlier block's tree
+	HF_LENGTHS = 0x10,		// file and block lengths, for counted decoding
+	HF_LZ77 = 0x20			// LZ77 matches with their own length and distance codes
+};
+
+// every flag this version understands
+const int HF_ALL_FLAGS = HF_BLOCKSORT | HF_FILTER | HF_CHECKSUM | HF_TABLEREF | HF_LENGTHS | HF_LZ77;
+
+const int HF_DEFAULT_BLOCK_SIZE = 1 << 20;
+
+// largest block: lengths are ints, and block sorting indexes a block with ints
+const int HF_MAX_BLOCK_SIZE = 1 << 30;
+
+// Bounds a block's payload. Codes are at most 32 bits, and an LZ77 match
+// costs at most about 100 bits for its 3 or more bytes, so no stage needs
+// 5 bytes per input byte. The trees, EOF codes and padding fit in the rest
+const int HF_PAYLOAD_PER_BYTE = 5;
+const int HF_PAYLOAD_OVERHEAD = 4096;
+
+// table source of a block that stores its own tree
+const unsigned int HF_INLINE_TABLE = 0xFFFFFFFF;
+
+// a table source may name any of the last 64 blocks that stored a tree
+const int HF_TABLE_WINDOW = 64;
+
+// default sample for one-pass compression: the first 4 MB plus 64 chunks
+const long long HF_DEFAULT_SAMPLE_PREFIX = 4 << 20;
+const int HF_DEFAULT_SAMPLE_COUNT = 64;
+
+// Selects how HuffTree::huff/unhuff process a file
+class HuffOptions
+{
+public:
+	bool pipelined;		// overlap reading, coding and writing
+	bool parallel;		// code original-format files on several threads
+	int threads;		// threads for parallel coding, 0 for one per core
+	bool blocksort;		// block-sorting front end (HF_BLOCKSORT)
+	int blocksize;		// bytes per block in the block format
+	int filters;		// FilterFlags to apply (HF_FILTER)
+	int filterwidth;	// element width for the filters, in bytes
+	bool sampled;		// one pass, with codes from a sample of the input
+	long long sampleprefix;	// bytes sampled from the start of the file
+	int samplecount;	// chunks sampled from the rest of the file
+	bool checksums;		// per-block checksums (HF_CHECKSUM)
+	bool sharedtables;	// cached tables, reused across blocks (HF_TABLEREF)
+	bool lengths;		// original lengths in the headers (HF_LENGTHS)
+	int lzlevel;		// LZ77 search effort, 0 for no LZ77 stage (HF_LZ77)
+
+	HuffOptions()
+		: pipelined(false), parallel(false), threads(0), blocksort(false), blocksize(HF_DEFAULT_BLOCK_SIZE), 
+		  filters(0), filterwidth(4), sampled(false), 
+		  sampleprefix(HF_DEFAULT_SAMPLE_PREFIX), samplecount(HF_DEFAULT_SAMPLE_COUNT),
+		  checksums(false), sharedtables(false), lengths(false), lzlevel(0)
+	{
+	}
+
+	// flags byte for the file header
+	int flags() const
+	{
+		return (blocksort ? HF_BLOCKSORT : 0) | (filters ? HF_FILTER : 0) | 
+			(checksums ? HF_CHECKSUM : 0) | (sharedtables ? HF_TABLEREF : 0) |
+			(lengths ? HF_LENGTHS : 0) | (lzlevel ? HF_LZ77 : 0);
+	}
+
+	// true when the block format is needed
+	bool blocked() const
+	{
+		return flags() != 0;
+	}
+};
+
+// Fields of a block format file header
+class HuffFileInfo
+{
+public:
+	int flags;
+	unsigned int blocksize;
+	int filters;
+	int filterwidth;
+	unsigned long long length;	// original file length (HF_LENGTHS)
+	int lzlevel;				// level the file was parsed at (HF_LZ77)
+
+	HuffFileInfo()
+		: flags(0), blocksize(0), filters(0), filterwidth(0), length(0), lzlevel(0)
+	{
+	}
+
+	explicit HuffFileInfo(const HuffOptions &options)
+		: flags(options.flags()), blocksize(options.blocksize), 
+		  filters(options.filters), filterwidth(options.filterwidth), length(0),
+		  lzlevel(options.lzlevel)
+	{
+	}
+};
+
+// One block as stored in a block format file
+class BlockRecord
+{
+public:
+	std::vector<unsigned char> payload;
+	unsigned int rawlength;		// bytes the block decodes to (HF_CHECKSUM, HF_LENGTHS)
+	unsigned int payloadcrc;	// CRC-32C of payload (HF_CHECKSUM)
+	unsigned int datacrc;		// CRC-32C of the decoded block (HF_CHECKSUM)
+	unsigned int symbols;		// symbols coded before the first PSEUDO_EOF (HF_LENGTHS)
+	unsigned int tableref;		// table source (HF_TABLEREF)
+
+	BlockRecord()
+		: rawlength(0), payloadcrc(0), datacrc(0), symbols(0), tableref(HF_INLINE_TABLE)
+	{
+	}
+};
+
+enum RecordStatus
+{
+	RECORD_OK,
+	RECORD_END,		// end of file marker
+	RECORD_BAD		// truncated or impossible record
+};
+
+// Big-endian integers, as stored in every header (HuffBlocks.cpp)
+void writeU32(std::ostream &out, unsigned int value);
+bool readU32(std::istream &in, unsigned int &value);
+void writeU64(std::ostream &out, unsigned long long value);
+bool readU64(std::istream &in, unsigned long long &value);
+
+// Reading and writing the framing of a block format file (HuffBlocks.cpp)
+void writeFormatHeader(std::ostream &out, const HuffFileInfo &info);
+bool readFormatHeader(std::istream &in, HuffFileInfo &info);
+void writeBlockRecord(std::ostream &out, const HuffFileInfo &info, const BlockRecord &record);
+void writeEndRecord(std::ostream &out);
+RecordStatus readBlockRecord(std::istream &in, const HuffFileInfo &info, BlockRecord &record);
+
+// Result of HuffTree::verify
+class VerifyReport
+{
+public:
+	int blocks;					// blocks examined
+	std::vector<int> badblocks;	// indexes of blocks that failed their checks
+	bool intact;				// false if the file's framing is damaged past repair
+	bool checksummed;			// false if the file has no checksums to test
+
+	VerifyReport()
+		: blocks(0), intact(true), checksummed(false)
+	{
+	}
+
+	bool ok() const
+	{
+		return intact && badblocks.empty();
+	}
+};
+
+#endif
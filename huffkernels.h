@@ -0,0 +1,426 @@
+#pragma once
+#ifndef _HUFFKERNELS_H
+#define _HUFFKERNELS_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: Encode/decode kernels specialized at compile time on the symbol
+	alphabet (bytes or 9-bit "wide" symbols), the decode table width and the
+	maximum code length. Fixing these as template parameters lets the compiler
+	unroll the emit/refill loops and keep the bit accumulators in registers.
+
+	HuffEncoder<Symbol>::create() and HuffDecoder<Symbol>::create() are the
+	runtime dispatchers: they look at the code lengths of a tree (usually one
+	just read from a file header) and return the matching instantiation. On
+	hosts with BMI2 the encoder's kernel is compiled for it, so the variable
+	shifts of its accumulator become single shlx instructions (see
+	cpufeatures.h). The decoder gained nothing from BMI2 and has one build.
+*/
+
+#include <vector>
+#include <cstring>
+#include "hufftree.h"
+#include "bitbuffer.h"
+#include "globals.h"
+#include "cpufeatures.h"
+
+// ---- Alphabets ---- //
+// Header leaves are 9 bits wide. Byte streams only use the low 8 bits of a
+// leaf value (older files store bytes >= 128 as negative chars), wide streams
+// use the whole value.
+template <typename Symbol> struct SymbolTraits;
+
+template <> struct SymbolTraits<unsigned char>
+{
+	enum { ALPHABET = 256, MASK = 0xFF };
+};
+
+template <> struct SymbolTraits<unsigned short>
+{
+	enum { ALPHABET = 512, MASK = 0x1FF };
+};
+
+/* Returns the length of the longest code in the map */
+inline int maxCodeLength(const HuffTree::CodeMap &codes)
+{
+	int maxlength = 0;
+	for (auto it = codes.begin(); it != codes.end(); it++)
+		if (it->second.first > maxlength)
+			maxlength = it->second.first;
+	return maxlength;
+}
+
+// ---- Encoding ---- //
+
+// symbol -> (length, code) flattened out of a CodeMap
+template <typename Symbol>
+class EncodeTable
+{
+public:
+	enum { ALPHABET = SymbolTraits<Symbol>::ALPHABET };
+
+	unsigned int code[ALPHABET];
+	unsigned char length[ALPHABET];
+	unsigned int eofcode;
+	int eoflength;
+
+	explicit EncodeTable(const HuffTree::CodeMap &codes)
+		: eofcode(0), eoflength(0)
+	{
+		memset(code, 0, sizeof(code));
+		memset(length, 0, sizeof(length));
+		for (auto it = codes.begin(); it != codes.end(); it++)
+		{
+			int value = it->first;
+			if (value == PSEUDO_EOF)
+			{
+				eoflength = it->second.first;
+				eofcode = (unsigned int)it->second.second;
+			}
+			if (value != PSEUDO_EOF || SymbolTraits<Symbol>::MASK >= PSEUDO_EOF)
+			{
+				int idx = value & SymbolTraits<Symbol>::MASK;
+				length[idx] = (unsigned char)it->second.first;
+				code[idx] = (unsigned int)it->second.second;
+			}
+		}
+	}
+};
+
+/*	Codes n symbols into out. MaxCodeLen bounds every code length, so
+	32 / MaxCodeLen codes always fit in the accumulator between word emits. */
+template <typename Symbol, int MaxCodeLen>
+void encodeKernel(const EncodeTable<Symbol> &table, const Symbol *in, size_t n, BitWriter &out)
+{
+	enum { UNROLL = 32 / MaxCodeLen };
+
+	out.emitBytes();
+	size_t i = 0;
+	for (; i + UNROLL <= n; i += UNROLL)
+	{
+		for (int k = 0; k < UNROLL; k++)
+		{
+			Symbol s = in[i + k];
+			out.put(table.length[s], table.code[s]);
+		}
+		out.emitWord();
+	}
+	for (; i < n; i++)
+	{
+		Symbol s = in[i];
+		out.put(table.length[s], table.code[s]);
+		out.emitWord();
+	}
+}
+
+template <typename Symbol>
+class HuffEncoder
+{
+public:
+	virtual ~HuffEncoder() {}
+
+	// codes n symbols into out
+	virtual void encode(const Symbol *in, size_t n, BitWriter &out) const = 0;
+
+	// codes PSEUDO_EOF into out
+	virtual void encodeEOF(BitWriter &out) const = 0;
+
+	// picks the kernel for the code lengths in codes; NULL if a code exceeds 32 bits
+	static HuffEncoder* create(const HuffTree::CodeMap &codes);
+};
+
+/* encodeKernel compiled for hosts with BMI2 */
+template <typename Symbol, int MaxCodeLen>
+HUFF_TARGET("bmi,bmi2") void encodeKernelBmi2(const EncodeTable<Symbol> &table, const Symbol *in, size_t n, BitWriter &out)
+{
+	encodeKernel<Symbol, MaxCodeLen>(table, in, n, out);
+}
+
+template <typename Symbol, int MaxCodeLen>
+class TableEncoder : public HuffEncoder<Symbol>
+{
+protected:
+	EncodeTable<Symbol> table_;
+
+public:
+	explicit TableEncoder(const HuffTree::CodeMap &codes)
+		: table_(codes)
+	{
+	}
+
+	void encode(const Symbol *in, size_t n, BitWriter &out) const
+	{
+		encodeKernel<Symbol, MaxCodeLen>(table_, in, n, out);
+	}
+
+	void encodeEOF(BitWriter &out) const
+	{
+		out.emitBytes();
+		out.put(table_.eoflength, table_.eofcode);
+		out.emitBytes();
+	}
+};
+
+template <typename Symbol, int MaxCodeLen>
+class Bmi2TableEncoder : public TableEncoder<Symbol, MaxCodeLen>
+{
+public:
+	explicit Bmi2TableEncoder(const HuffTree::CodeMap &codes)
+		: TableEncoder<Symbol, MaxCodeLen>(codes)
+	{
+	}
+
+	void encode(const Symbol *in, size_t n, BitWriter &out) const
+	{
+		encodeKernelBmi2<Symbol, MaxCodeLen>(this->table_, in, n, out);
+	}
+};
+
+/* The encoder for MaxCodeLen best suited to this host */
+template <typename Symbol, int MaxCodeLen>
+HuffEncoder<Symbol>* newTableEncoder(const HuffTree::CodeMap &codes)
+{
+	if (cpuFeatures().bmi2)
+		return new Bmi2TableEncoder<Symbol, MaxCodeLen>(codes);
+	return new TableEncoder<Symbol, MaxCodeLen>(codes);
+}
+
+template <typename Symbol>
+HuffEncoder<Symbol>* HuffEncoder<Symbol>::create(const HuffTree::CodeMap &codes)
+{
+	int maxlength = maxCodeLength(codes);
+
+	if (maxlength <= 8)
+		return newTableEncoder<Symbol, 8>(codes);
+	else if (maxlength <= 16)
+		return newTableEncoder<Symbol, 16>(codes);
+	else if (maxlength <= 32)
+		return newTableEncoder<Symbol, 32>(codes);
+	return NULL;
+}
+
+// ---- Decoding ---- //
+
+enum DecodeStatus
+{
+	DECODE_FULL,		// output buffer filled, more symbols follow
+	DECODE_EOF,			// PSEUDO_EOF decoded
+	DECODE_TRUNCATED	// input ended before PSEUDO_EOF
+};
+
+/*	Lookup table indexed by the next TableBits bits of input. Codes longer than
+	TableBits escape into a bit-at-a-time trie holding their remaining bits. */
+template <int TableBits>
+class DecodeTable
+{
+public:
+	struct Entry
+	{
+		unsigned short symbol;	// leaf value, or trie node when length == 0
+		unsigned short length;	// code length, 0 for an escape into the trie
+	};
+
+	enum { UNSET = 0xFFFF };
+
+	struct TrieNode
+	{
+		int child[2];
+		int symbol;		// -1 for internal nodes
+	};
+
+	std::vector<Entry> entry;
+	std::vector<TrieNode> trie;
+
+	explicit DecodeTable(const HuffTree::CodeMap &codes)
+		: entry(1 << TableBits)
+	{
+		for (size_t i = 0; i < entry.size(); i++)
+		{
+			entry[i].symbol = 0;
+			entry[i].length = UNSET;
+		}
+
+		for (auto it = codes.begin(); it != codes.end(); it++)
+		{
+			int symbol = it->first & 0x1FF;
+			int length = it->second.first;
+			unsigned int code = (unsigned int)it->second.second;
+
+			if (length <= TableBits)
+			{	// every index starting with this code decodes to symbol
+				unsigned int first = code << (TableBits - length);
+				unsigned int count = 1u << (TableBits - length);
+				for (unsigned int i = 0; i < count; i++)
+				{
+					entry[first + i].symbol = (unsigned short)symbol;
+					entry[first + i].length = (unsigned short)length;
+				}
+			}
+			else
+			{	// hang the code's tail off the trie node for its prefix
+				Entry &e = entry[code >> (length - TableBits)];
+				if (e.length == UNSET)
+				{
+					e.symbol = (unsigned short)newNode();
+					e.length = 0;
+				}
+				int node = e.symbol;
+				for (int bit = length - TableBits - 1; bit >= 0; bit--)
+				{
+					int b = (code >> bit) & 1;
+					if (trie[node].child[b] < 0)
+					{
+						int child = newNode();
+						trie[node].child[b] = child;
+					}
+					node = trie[node].child[b];
+				}
+				trie[node].symbol = symbol;
+			}
+		}
+	}
+
+	/* Finishes decoding a long code, starting at trie node */
+	int walk(int node, BitReader &in) const
+	{
+		while (trie[node].symbol < 0)
+			node = trie[node].child[in.bit()];
+		return trie[node].symbol;
+	}
+
+private:
+	int newNode()
+	{
+		TrieNode n;
+		n.child[0] = n.child[1] = -1;
+		n.symbol = -1;
+		trie.push_back(n);
+		return int(trie.size()) - 1;
+	}
+};
+
+/*	Decodes symbols from in until PSEUDO_EOF, end of input, or capacity symbols
+	have been stored in out. When MaxCodeLen <= TableBits the escape path is
+	compiled out and several symbols are decoded per accumulator refill. When
+	Counted, the caller knows exactly how many symbols precede PSEUDO_EOF, so
+	the compare against it is compiled out as well. */
+template <typename Symbol, int TableBits, int MaxCodeLen, bool Counted>
+DecodeStatus decodeKernel(const DecodeTable<TableBits> &table, BitReader &in,
+	Symbol *out, size_t capacity, size_t &count)
+{
+	typedef typename DecodeTable<TableBits>::Entry Entry;
+
+	// a refill guarantees 57 bits; leave TableBits for the final peek
+	enum { DIRECT = MaxCodeLen <= TableBits };
+	enum { UNROLL = DIRECT ? (57 - TableBits) / MaxCodeLen + 1 : 1 };
+
+	count = 0;
+	for (;;)
+	{
+		if (capacity - count < size_t(UNROLL))
+			break;
+
+		in.refill();
+		for (int k = 0; k < UNROLL; k++)
+		{
+			const Entry &e = table.entry[in.peek(TableBits)];
+			int symbol;
+			if (DIRECT || e.length != 0)
+			{
+				in.consume(e.length);
+				symbol = e.symbol;
+			}
+			else
+			{
+				in.consume(TableBits);
+				symbol = table.walk(e.symbol, in);
+			}
+
+			if (!Counted && symbol == PSEUDO_EOF)
+				return in.overrun() ? DECODE_TRUNCATED : DECODE_EOF;
+			out[count++] = Symbol(symbol);
+		}
+		if (in.overrun())
+			return DECODE_TRUNCATED;
+	}
+
+	// not enough room left for a whole unrolled step, finish one at a time
+	while (count < capacity)
+	{
+		in.refill();
+		const Entry &e = table.entry[in.peek(TableBits)];
+		int symbol;
+		if (DIRECT || e.length != 0)
+		{
+			in.consume(e.length);
+			symbol = e.symbol;
+		}
+		else
+		{
+			in.consume(TableBits);
+			symbol = table.walk(e.symbol, in);
+		}
+
+		if (in.overrun())
+			return DECODE_TRUNCATED;
+		if (!Counted && symbol == PSEUDO_EOF)
+			return DECODE_EOF;
+		out[count++] = Symbol(symbol);
+	}
+	return DECODE_FULL;
+}
+
+template <typename Symbol>
+class HuffDecoder
+{
+public:
+	virtual ~HuffDecoder() {}
+
+	// decodes up to capacity symbols into out, stopping early at PSEUDO_EOF
+	virtual DecodeStatus decode(BitReader &in, Symbol *out, size_t capacity, size_t &count) const = 0;
+
+	// decodes exactly count symbols into out; DECODE_FULL once all are stored
+	virtual DecodeStatus decodeCounted(BitReader &in, Symbol *out, size_t count) const = 0;
+
+	// picks the table width for the code lengths in codes
+	static HuffDecoder* create(const HuffTree::CodeMap &codes);
+};
+
+template <typename Symbol, int TableBits, int MaxCodeLen>
+class TableDecoder : public HuffDecoder<Symbol>
+{
+private:
+	DecodeTable<TableBits> table_;
+
+public:
+	explicit TableDecoder(const HuffTree::CodeMap &codes)
+		: table_(codes)
+	{
+	}
+
+	DecodeStatus decode(BitReader &in, Symbol *out, size_t capacity, size_t &count) const
+	{
+		return decodeKernel<Symbol, TableBits, MaxCodeLen, false>(table_, in, out, capacity, count);
+	}
+
+	DecodeStatus decodeCounted(BitReader &in, Symbol *out, size_t count) const
+	{
+		size_t decoded;
+		return decodeKernel<Symbol, TableBits, MaxCodeLen, true>(table_, in, out, count, decoded);
+	}
+};
+
+template <typename Symbol>
+HuffDecoder<Symbol>* HuffDecoder<Symbol>::create(const HuffTree::CodeMap &codes)
+{
+	int maxlength = maxCodeLength(codes);
+
+	if (maxlength <= 8)
+		return new TableDecoder<Symbol, 8, 8>(codes);
+	else if (maxlength <= 11)
+		return new TableDecoder<Symbol, 11, 11>(codes);
+	return new TableDecoder<Symbol, 11, MAX_CODE_LENGTH>(codes);
+}
+
+#endif
@@ -12,13 +12,68 @@
 #include <queue>
 #include "bitops.h"
 #include "globals.h"
+#include "huffkernels.h"
+#include "huffformat.h"
+#include "bytecounts.h"
 
 using namespace std;
 
 // Intermediate functions for building the Huffman Tree
 Histogram* fileHistogram(ifstream &infile);
+Histogram* countsHistogram(const long long counts[256]);
+Histogram* sampleHistogram(ifstream &infile, long long prefix, int samples);
 string code2str(const HuffTree::CodePair &cp);
 
+// size of the blocks moved between the file streams and the kernels
+const int IO_CHUNK_SIZE = 1 << 16;
+
+/* Feeds the bits that follow a file header into a BitReader */
+class IbstreamSource : public ByteSource
+{
+private:
+	ibstream &in_;
+	bool done_;
+
+public:
+	IbstreamSource(ibstream &in)
+		: in_(in), done_(false)
+	{
+	}
+
+	size_t read(unsigned char *buf, size_t n)
+	{
+		size_t count = 0;
+		int inbits;
+		while (!done_ && count < n)
+		{
+			if (in_.readbits(8, inbits))
+				buf[count++] = (unsigned char)inbits;
+			else
+			{	// the header isn't byte sized, so the last few bits are a partial byte
+				int partial = 0, nbits = 0;
+				while (nbits < 8 && in_.readbits(1, inbits))
+				{
+					partial = (partial << 1) | inbits;
+					nbits++;
+				}
+				if (nbits > 0)
+					buf[count++] = (unsigned char)(partial << (8 - nbits));
+				done_ = true;
+			}
+		}
+		return count;
+	}
+};
+
+/* Moves the whole bytes held by a BitWriter out to an obstream */
+void drainBits(BitWriter &bits, obstream &outfile)
+{
+	vector<unsigned char> &bytes = bits.bytes();
+	for (size_t i = 0; i < bytes.size(); i++)
+		outfile.writebits(8, bytes[i]);
+	bytes.clear();
+}
+
 HuffTree::HuffTree(int root_key, int root_value)
 	: root(new TreeNode(root_key, root_value))
 {
@@ -63,15 +118,72 @@ bool HuffTree::huff(const string &srcFileName, const string &destFileName)
 /* Uncompresses srcFile into destFile */
 bool HuffTree::unhuff(const string &srcFileName, const string &destFileName)
 {
+	if (isBlockFile(srcFileName))
+		return unhuffBlocks(srcFileName, destFileName);
+
 	ibstream infile(srcFileName);
 	ofstream outfile(destFileName);
 
 	HuffPtr hufftree = HuffTree::treeFromHeader(infile);
-	hufftree->decompressFile(infile, outfile);
+	if (hufftree == NULL)
+		return false;
+	bool complete = hufftree->decompressFile(infile, outfile);
+
+	delete hufftree;
+	return complete;
+}
+
+/* Compresses srcFile into destFile using the format and stages in options */
+bool HuffTree::huff(const string &srcFileName, const string &destFileName, const HuffOptions &options)
+{
+	if (options.blocked())
+		return huffBlocks(srcFileName, destFileName, options);
+	else if (options.sampled)
+		return huffSampled(srcFileName, destFileName, options);
+	else if (options.parallel)
+		return huffParallel(srcFileName, destFileName, options.threads);
+	else if (options.pipelined)
+		return huffPipelined(srcFileName, destFileName);
+	else
+		return huff(srcFileName, destFileName);
+}
+
+/*	Compresses srcFile into destFile in a single pass over the input, with
+	codes built from a sample of the file instead of a full histogram */
+bool HuffTree::huffSampled(const string &srcFileName, const string &destFileName, const HuffOptions &options)
+{
+	// open both readers before sampling, so a failed open has nothing to free
+	ifstream sample(srcFileName.c_str(), ios::binary);
+	ifstream infile(srcFileName.c_str());
+	if (!sample || !infile)
+		return false;
+	Histogram *hist = sampleHistogram(sample, options.sampleprefix, options.samplecount);
+	sample.close();
 
+	obstream outfile(destFileName);
+	HuffPtr hufftree = buildHuffTree(*hist);
+	hufftree->writeFileHeader(outfile);
+	hufftree->compressFile(infile, outfile);
+
+	infile.close();
+	outfile.close();
+
+	delete hufftree;
+	delete hist;
 	return true;
 }
 
+/* Uncompresses srcFile into destFile; the format is detected from the file */
+bool HuffTree::unhuff(const string &srcFileName, const string &destFileName, const HuffOptions &options)
+{
+	if (options.parallel)
+		return unhuffParallel(srcFileName, destFileName, options.threads);
+	else if (options.pipelined)
+		return unhuffPipelined(srcFileName, destFileName);
+	else
+		return unhuff(srcFileName, destFileName);
+}
+
 /* Generates huffman codes from tree */
 HuffTree::CodeMap* HuffTree::generateHuffCodes() const
 {
@@ -100,14 +212,16 @@ void HuffTree::generateHuffCodes(TreeNode *root, CodeMap &huffcodes, int length,
 }
 
 /* Stores copy of tree in file header */
-void HuffTree::writeFileHeader(obstream &outfile) const
+template <class BitStream>
+void HuffTree::writeFileHeader(BitStream &outfile) const
 {
 	if (root)
 		writeFileHeader(root, outfile);
 }
 
 /* Copies tree to file using recursive pre-order traversal */
-void HuffTree::writeFileHeader(TreeNode *root, obstream &outfile) const
+template <class BitStream>
+void HuffTree::writeFileHeader(TreeNode *root, BitStream &outfile) const
 {
 	if (root->left == NULL && root->right == NULL)
 	{	// leaf, write 1 and 9-bit (Ascii+1) value
@@ -124,83 +238,115 @@ void HuffTree::writeFileHeader(TreeNode *root, obstream &outfile) const
 	}
 }
 
-/* Compresses infile into outfile one char at a time using huffman codes */
+/* Compresses infile into outfile one chunk at a time using huffman codes */
 void HuffTree::compressFile(ifstream &infile, obstream &outfile) const
 {
 	CodeMap *huffcodes = generateHuffCodes();
+	HuffEncoder<unsigned char> *encoder = HuffEncoder<unsigned char>::create(*huffcodes);
 
+	// buildHuffTree keeps every code within the kernels' 32 bits, so the encoder always exists
 	if (infile)
 	{
-		char ch;
-		CodePair codepair;
-		int length, code;
-		while (infile.get(ch))
-		{	// write the huffcode for each character in the file
-			codepair = (*huffcodes)[ch];
-			length = codepair.first;
-			code = codepair.second;
-			outfile.writebits(length, code);
+		vector<char> buf(IO_CHUNK_SIZE);
+		BitWriter bits;
+		while (infile.read(&buf[0], buf.size()) || infile.gcount() > 0)
+		{	// code a whole chunk with the specialized kernel, then hand it off
+			encoder->encode((const unsigned char*)&buf[0], size_t(infile.gcount()), bits);
+			drainBits(bits, outfile);
 		}
-		codepair = (*huffcodes)[PSEUDO_EOF];
-		length = codepair.first;
-		code = codepair.second;
-		outfile.writebits(length, code);
+		encoder->encodeEOF(bits);
+		drainBits(bits, outfile);
+		outfile.writebits(bits.nbits(), bits.pendingBits());
 	}
+
+	delete encoder;
+	delete huffcodes;
 }
 
-/* Creates huffman tree from header of huffed file */
-HuffPtr HuffTree::treeFromHeader(ibstream &infile)
+/*	Creates huffman tree from header of huffed file. Returns NULL if the
+	header is cut short, describes more nodes than any real tree has, or
+	gives a code longer than MAX_CODE_LENGTH. */
+template <class BitStream>
+HuffPtr HuffTree::treeFromHeader(BitStream &infile)
 {
+	// a full tree over 258 symbols has 515 nodes; anything past 1023 is garbage
+	int budget = 1023;
+	TreeNode *root = treeFromHeaderHelper(infile, budget, 0);
+	if (root == NULL)
+		return NULL;
+	if (root->left == NULL && root->value != PSEUDO_EOF)
+	{	// a lone leaf has a 0 bit code, which only an empty file's PSEUDO_EOF may have
+		deleteTree(root);
+		return NULL;
+	}
+
 	HuffPtr ht = new HuffTree();
-	ht->root = treeFromHeaderHelper(infile);
+	ht->root = root;
 	return ht;
 }
 
 /* Recursively builds Huffman Tree from pre-order traversal in file header */
-HuffTree::TreeNode* HuffTree::treeFromHeaderHelper(ibstream &infile)
+template <class BitStream>
+HuffTree::TreeNode* HuffTree::treeFromHeaderHelper(BitStream &infile, int &budget, int depth)
 {
+	if (--budget < 0 || depth > MAX_CODE_LENGTH)
+		return NULL;
+
 	// read a 1 bit value
 	int inbits;
-	infile.readbits(1, inbits);
+	if (!infile.readbits(1, inbits))
+		return NULL;
 	if (inbits) // if a 1 is read, build a leaf node
 	{
-		infile.readbits(9, inbits);	// read a 9 bit value 
+		if (!infile.readbits(9, inbits))	// read a 9 bit value 
+			return NULL;
 		return new TreeNode(0, inbits); // store it in a new node and return its address
 	}
 	else
 	{ // create an internal node -- this node necessarily has 2 children
-		TreeNode *left = treeFromHeaderHelper(infile); 
-		TreeNode *right = treeFromHeaderHelper(infile);
+		TreeNode *left = treeFromHeaderHelper(infile, budget, depth + 1); 
+		TreeNode *right = left ? treeFromHeaderHelper(infile, budget, depth + 1) : NULL;
+		if (right == NULL)
+		{
+			deleteTree(left);
+			return NULL;
+		}
 
 		return new TreeNode(0, 0, left, right);
 	}
 }
 
-/* Decompresses infile into outfile by traversing tree while reading codes */
-void HuffTree::decompressFile(ibstream &infile, std::ofstream &outfile) const
+/*	Decompresses infile into outfile using a decode table built from the tree.
+	Returns false if the codes run out before PSEUDO_EOF. */
+bool HuffTree::decompressFile(ibstream &infile, std::ostream &outfile) const
 {
-	using namespace std;
+	CodeMap *huffcodes = generateHuffCodes();
+	HuffDecoder<unsigned char> *decoder = HuffDecoder<unsigned char>::create(*huffcodes);
+
+	IbstreamSource source(infile);
+	BitReader bits(source);
+	vector<unsigned char> buf(IO_CHUNK_SIZE);
 
-	bool hitEOF = false;
-	while (!hitEOF)
+	DecodeStatus status;
+	do
 	{
-		int inbit;
-		TreeNode *it = root;
-		while (it->left != NULL && it->right != NULL) // while child not reached
-		{	// read bit, traverse tree
-			infile.readbits(1, inbit);
-			if (inbit == 0)
-				it = it->left;
-			else
-				it = it->right;
-		}
-		if (it->value == PSEUDO_EOF) 
-			hitEOF = true;
-		else
-			outfile.put(char(it->value));
-	}
+		size_t count;
+		status = decoder->decode(bits, &buf[0], buf.size(), count);
+		outfile.write((const char*)&buf[0], count);
+	} while (status == DECODE_FULL);
+
+	delete decoder;
+	delete huffcodes;
+	return status == DECODE_EOF;
 }
 
+// header code for the in-memory bit streams, used by the pipelined coders
+template void HuffTree::writeFileHeader<BitWriter>(BitWriter &outfile) const;
+template HuffPtr HuffTree::treeFromHeader<BitReader>(BitReader &infile);
+
+// used by HuffTree::verify for original-format files
+template HuffPtr HuffTree::treeFromHeader<ibstream>(ibstream &infile);
+
 HuffTree::~HuffTree()
 {
 	deleteTree(root);
@@ -236,21 +382,134 @@ HuffPtr HuffTree::join(const HuffTree &ht1, const HuffTree &ht2)
 /* Creates mapping of characters to frequencies (histogram) */
 Histogram* fileHistogram(ifstream &infile)
 {
-	Histogram *hist = NULL;
-	char ch;
+	if (!infile)
+		return NULL;
 
-	if (infile)
+	long long counts[256] = { 0 };
+	vector<char> buf(IO_CHUNK_SIZE);
+	while (infile.read(&buf[0], buf.size()) || infile.gcount() > 0)
+		countBytes((const unsigned char*)&buf[0], size_t(infile.gcount()), counts);
+
+	return countsHistogram(counts);
+}
+
+/*	Creates a histogram from per-byte counts. Bytes are keyed as chars, the
+	same way fileHistogram keys them, so both produce the same tree. */
+Histogram* countsHistogram(const long long counts[256])
+{
+	long long total = 0;
+	for (int i = 0; i < 256; i++)
+		total += counts[i];
+
+	// the tree's weights are ints, so counts summing past 2^30 are scaled down, as recordCodes does;
+	// a byte that occurs keeps a weight of at least 1 so it still gets a code
+	int shift = 0;
+	while ((total >> shift) + 257 > (1LL << 30))
+		shift++;
+
+	Histogram *hist = new Histogram;
+	for (int i = 0; i < 256; i++)
+		if (counts[i] > 0)
+			(*hist)[char(i)] = int(max(1LL, counts[i] >> shift));
+
+	(*hist)[PSEUDO_EOF] = 1;
+	return hist;
+}
+
+/*	Estimates the histogram of a file from its first prefix bytes plus
+	samples evenly spaced chunks after that. Every byte value gets a count of
+	at least 1 so it has a code even if the sample never saw it. */
+Histogram* sampleHistogram(ifstream &infile, long long prefix, int samples)
+{
+	long long counts[256];
+	for (int i = 0; i < 256; i++)
+		counts[i] = 1;
+
+	infile.seekg(0, infile.end);
+	long long size = infile.tellg();
+	infile.seekg(0, infile.beg);
+
+	vector<char> buf(IO_CHUNK_SIZE);
+	long long remaining = min(prefix, size);
+	while (remaining > 0 && infile.read(&buf[0], min(remaining, (long long)buf.size())))
 	{
-		hist = new Histogram;
-		while (infile.get(ch))
-			(*hist)[ch] += 1;
+		countBytes((const unsigned char*)&buf[0], size_t(infile.gcount()), counts);
+		remaining -= infile.gcount();
+	}
 
-		(*hist)[PSEUDO_EOF] = 1;
+	// strided chunks through the rest of the file
+	long long rest = size - prefix;
+	if (rest > 0)
+	{
+		for (int k = 0; k < samples; k++)
+		{
+			infile.clear();
+			infile.seekg(prefix + rest * k / samples);
+			infile.read(&buf[0], buf.size());
+			countBytes((const unsigned char*)&buf[0], size_t(infile.gcount()), counts);
+		}
 	}
-	return hist;
+
+	return countsHistogram(counts);
 }
 
+/*	Codes for records of bytes that each end in PSEUDO_EOF. Bytes that never
+	occur still get a code, so later records can use them. Counts are scaled
+	down until the tree's weights fit in an int, then the rarest symbols are
+	raised to a floor that doubles until no code is longer than maxlength
+	bits (at least 9, enough for 257 symbols). */
+HuffTree::CodeMap* HuffTree::recordCodes(const long long counts[256], long long records, int maxlength)
+{
+	long long total = records;
+	for (int i = 0; i < 256; i++)
+		total += counts[i];
+
+	int shift = 0;
+	while ((total >> shift) + 257 > (1LL << 30))
+		shift++;
+
+	for (int floor = 1;; floor *= 2)
+	{
+		Histogram hist;
+		for (int i = 0; i < 256; i++)
+			hist[i] = int(max((long long)floor, counts[i] >> shift));
+		hist[PSEUDO_EOF] = int(max((long long)floor, records >> shift));
+
+		HuffPtr hufftree = buildHuffTree(hist);
+		CodeMap *huffcodes = hufftree->generateHuffCodes();
+		delete hufftree;
+		if (maxCodeLength(*huffcodes) <= maxlength)
+			return huffcodes;
+		delete huffcodes;
+	}
+}
+
+/*	Builds the Huffman tree for hist. A tree deeper than MAX_CODE_LENGTH
+	is built again with a doubling floor under the smallest weights, as
+	recordCodes does, until it fits. */
 HuffPtr HuffTree::buildHuffTree(const Histogram &hist)
+{
+	HuffPtr result = joinHistogram(hist);
+	Histogram raised(hist);
+	for (int floor = 2; result && depth(result->root) > MAX_CODE_LENGTH; floor *= 2)
+	{
+		for (auto it = raised.begin(); it != raised.end(); it++)
+			it->second = max(it->second, floor);
+		delete result;
+		result = joinHistogram(raised);
+	}
+	return result;
+}
+
+/* Levels in the tree under root, not counting root itself */
+int HuffTree::depth(const TreeNode *root)
+{
+	if (root == NULL || root->left == NULL)
+		return 0;
+	return 1 + max(depth(root->left), depth(root->right));
+}
+
+HuffPtr HuffTree::joinHistogram(const Histogram &hist)
 {	
 	typedef	priority_queue<HuffPtr, vector<HuffPtr>, HuffPtrComparer> HuffPtrPQ;
 
@@ -12,13 +12,33 @@
 */
 
 #include <map>
+#include <memory>
 #include <utility>	// std::pair -- used for internal types CodePair, CodeMap
 #include <fstream>
+#include <string>
+#include <vector>
 
 // forward declarations from bitops.h
 class obstream;
 class ibstream;
 
+// forward declarations from bitbuffer.h
+class BitWriter;
+class BitReader;
+
+// forward declarations from huffformat.h
+class HuffOptions;
+class HuffFileInfo;
+class BlockRecord;
+class VerifyReport;
+
+// forward declaration from huffarchive.h
+class ArchiveEntry;
+
+// forward declarations from tablecache.h
+class CodeTable;
+class TableWindow;
+
 // forward delcaration for HuffPtr
 class HuffTree;
 
@@ -26,6 +46,9 @@ class HuffTree;
 typedef		std::map<int, int>	Histogram;
 typedef		HuffTree*			HuffPtr;
 
+// longest code a tree may give; buildHuffTree never goes deeper and treeFromHeader rejects deeper trees
+const int MAX_CODE_LENGTH = 32;
+
 class HuffTree
 {
 private:
@@ -70,20 +93,82 @@ public:
 	static bool huff(const std::string &srcFileName, const std::string &destFileName);
 	static bool unhuff(const std::string &srcFileName, const std::string &destFileName);
 
+	// Same as huff/unhuff, but reading, coding and writing run concurrently
+	static bool huffPipelined(const std::string &srcFileName, const std::string &destFileName);
+	static bool unhuffPipelined(const std::string &srcFileName, const std::string &destFileName);
+
+	// Codes an original-format file on several threads at once (0 for one per core)
+	static bool huffParallel(const std::string &srcFileName, const std::string &destFileName, int threads);
+	static bool unhuffParallel(const std::string &srcFileName, const std::string &destFileName, int threads);
+
+	// Compress / decompress with the stages selected in options (see huffformat.h)
+	static bool huff(const std::string &srcFileName, const std::string &destFileName, const HuffOptions &options);
+	static bool unhuff(const std::string &srcFileName, const std::string &destFileName, const HuffOptions &options);
+
+	// In-memory compress / decompress. huff always writes the block format,
+	// unhuff reads either format; see HuffBlocks.cpp
+	static bool huff(const std::vector<unsigned char> &src, std::vector<unsigned char> &dest, const HuffOptions &options);
+	static bool unhuff(const std::vector<unsigned char> &src, std::vector<unsigned char> &dest);
+
+	// Byte offsets of every occurrence of pattern in a compressed file; see HuffSearch.cpp
+	static bool search(const std::string &fileName, const std::string &pattern, std::vector<unsigned long long> &offsets);
+
+	// Codes for a collection of records that each end in PSEUDO_EOF, from the
+	// collection's byte counts; every byte gets a code of at most maxlength bits
+	static CodeMap* recordCodes(const long long counts[256], long long records, int maxlength);
+
+	// true if the file is in the block format rather than the original one
+	static bool isBlockFile(const std::string &fileName);
+
+	// Checks a compressed file for damage without writing it out; see HuffBlocks.cpp
+	static bool verify(const std::string &fileName, bool deep, VerifyReport &report);
+
+	// Multi-file archives (see huffarchive.h), implemented in HuffArchive.cpp
+	static bool archive(const std::vector<std::string> &srcFileNames, const std::string &destFileName, bool sharedTable);
+	static bool listArchive(const std::string &archiveName, std::vector<ArchiveEntry> &entries);
+	static bool extract(const std::string &archiveName, const std::string &memberName, const std::string &destFileName);
+	static bool extract(const std::string &archiveName, const std::vector<std::string> &memberNames, const std::vector<std::string> &destFileNames);
+
 private:
 	// Internal methods -- not part of the public interface
 	HuffTree();
 	CodeMap* generateHuffCodes() const;
 	void generateHuffCodes(TreeNode *root, CodeMap &huffcodes, int length, int code) const;
-	void writeFileHeader(obstream &outstream) const;
-	void writeFileHeader(TreeNode *root, obstream &outstream) const;
+	template <class BitStream> void writeFileHeader(BitStream &outstream) const;
+	template <class BitStream> void writeFileHeader(TreeNode *root, BitStream &outstream) const;
 	void compressFile(std::ifstream &infile, obstream &outfile) const;
-	void decompressFile(ibstream &instream, std::ofstream &outstream) const;
-	void deleteTree(TreeNode *root);
+	bool decompressFile(ibstream &instream, std::ostream &outstream) const;
+	static void deleteTree(TreeNode *root);
 	static HuffPtr join(const HuffTree &ht1, const HuffTree &ht2);
 	static HuffPtr buildHuffTree(const Histogram &hist);
-	static HuffPtr treeFromHeader(ibstream &instream);
-	static TreeNode* treeFromHeaderHelper(ibstream &instream);
+	static HuffPtr joinHistogram(const Histogram &hist);
+	static int depth(const TreeNode *root);
+	template <class BitStream> static HuffPtr treeFromHeader(BitStream &instream);
+	template <class BitStream> static TreeNode* treeFromHeaderHelper(BitStream &instream, int &budget, int depth);
+
+	static bool huffSampled(const std::string &srcFileName, const std::string &destFileName, const HuffOptions &options);
+
+	// block format, implemented in HuffBlocks.cpp
+	static bool huffBlocks(const std::string &srcFileName, const std::string &destFileName, const HuffOptions &options);
+	static bool unhuffBlocks(const std::string &srcFileName, const std::string &destFileName);
+	static bool huffBlocks(std::istream &instream, std::ostream &outstream, const HuffOptions &options);
+	static bool unhuffBlocks(std::istream &instream, std::ostream &outstream);
+	static void encodeBlock(const HuffFileInfo &info, const unsigned char *data, int n, unsigned int index, TableWindow &window, BlockRecord &record);
+	static bool decodeBlock(const HuffFileInfo &info, const BlockRecord &record, std::shared_ptr<const CodeTable> &table, std::vector<unsigned char> &data);
+	static std::shared_ptr<const CodeTable> blockTable(const HuffFileInfo &info, const BlockRecord &record);
+	static bool searchBlocks(std::istream &instream, const std::string &pattern, std::vector<unsigned long long> &offsets);
+
+	// code tables, implemented in HuffTables.cpp
+	static std::shared_ptr<const CodeTable> exactTable(const std::vector<int> &counts);
+	static std::shared_ptr<const CodeTable> tableForCounts(const std::vector<int> &counts, std::string &key);
+	static std::shared_ptr<const CodeTable> tableFromHeader(BitReader &instream);
+	static void writeCodes(const CodeTable &table, const unsigned short *symbols, size_t count, BitWriter &outstream);
+	static bool readCodes(const CodeTable &table, BitReader &instream, std::vector<unsigned short> &symbols);
+	static bool readCodes(const CodeTable &table, BitReader &instream, size_t count, std::vector<unsigned short> &symbols);
+	static bool readEOF(const CodeTable &table, BitReader &instream);
+
+	// archives, implemented in HuffArchive.cpp
+	static bool extractMember(std::istream &instream, const std::shared_ptr<const CodeTable> &shared, const ArchiveEntry &entry, const std::string &destFileName);
 };
 
 #endif
\ No newline at end of file
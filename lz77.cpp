@@ -0,0 +1,278 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of the LZ77 stage declared in lz77.h.
+*/
+
+#include "lz77.h"
+#include <cstring>
+#include "bitbuffer.h"
+
+using namespace std;
+
+const int HASH_BITS = 16;
+
+// a minimum length match further back than this costs more than its literals
+const int TOO_FAR = 4096;
+
+// Search effort for one level
+class LzLevel
+{
+public:
+	int chain;		// candidates examined per position
+	int nice;		// a match this long ends the search
+	int lazy;		// matches shorter than this are checked against the next position
+	int window;		// furthest distance searched, at most LZ_WINDOW
+};
+
+/*	zlib's trade-offs up to level 6, which also keeps its 32 KB window: walking
+	chains through a larger window misses the cache on every candidate. The
+	top levels search further back. */
+const LzLevel LZ_LEVELS[LZ_MAX_LEVEL + 1] =
+{
+	{ 0, 0, 0, 0 },		// unused
+	{ 4, 8, 0, 1 << 15 },
+	{ 8, 16, 0, 1 << 15 },
+	{ 32, 32, 0, 1 << 15 },
+	{ 16, 16, 4, 1 << 15 },
+	{ 32, 32, 16, 1 << 15 },
+	{ 128, 128, 16, 1 << 15 },
+	{ 256, 128, 32, 1 << 18 },
+	{ 1024, 258, 128, 1 << 18 },
+	{ 4096, 258, 258, 1 << 18 }
+};
+
+/*	Splits v into its bucket and the extra bits that place it inside the
+	bucket (see lz77.h) */
+int bucketOf(unsigned int v, int &extrabits, unsigned int &extra)
+{
+	if (v < 4)
+	{
+		extrabits = 0;
+		extra = 0;
+		return int(v);
+	}
+
+	int e = 2;
+	while ((v >> (e + 1)) != 0)
+		e++;
+	extrabits = e - 1;
+	extra = v & ((1u << extrabits) - 1);
+	return 2 * e + int((v >> extrabits) & 1);
+}
+
+/* First value of bucket, and the number of extra bits that follow it */
+unsigned int bucketBase(int bucket, int &extrabits)
+{
+	if (bucket < 4)
+	{
+		extrabits = 0;
+		return unsigned(bucket);
+	}
+	extrabits = bucket / 2 - 1;
+	return unsigned(2 + (bucket & 1)) << extrabits;
+}
+
+/* Length of the common prefix of a and b, up to limit bytes */
+inline int matchLength(const unsigned char *a, const unsigned char *b, int limit)
+{
+	int len = 0;
+	while (len + 8 <= limit)
+	{
+		unsigned long long x, y;
+		memcpy(&x, a + len, 8);
+		memcpy(&y, b + len, 8);
+		if (x != y)
+			break;
+		len += 8;
+	}
+	while (len < limit && a[len] == b[len])
+		len++;
+	return len;
+}
+
+// Hash chains over the positions of one block
+class MatchFinder
+{
+private:
+	const unsigned char *in_;
+	int n_;
+	LzLevel level_;
+	vector<int> head_;	// latest position with each hash, -1 if none
+	vector<int> prev_;	// previous position with the same hash
+
+	unsigned int hash(int pos) const
+	{
+		unsigned int v = (unsigned(in_[pos]) << 16) | (unsigned(in_[pos + 1]) << 8) | in_[pos + 2];
+		return (v * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+public:
+	MatchFinder(const unsigned char *in, int n, int level)
+		: in_(in), n_(n), level_(LZ_LEVELS[level]), head_(1 << HASH_BITS, -1), prev_(n)
+	{
+	}
+
+	/* Adds pos to its chain */
+	void insert(int pos)
+	{
+		if (pos + LZ_MIN_MATCH > n_)
+			return;
+		unsigned int h = hash(pos);
+		prev_[pos] = head_[h];
+		head_[h] = pos;
+	}
+
+	/* Longest match for pos among the positions inserted so far; length 0 if none */
+	void find(int pos, int &length, int &distance) const
+	{
+		length = 0;
+		distance = 0;
+		int limit = n_ - pos < LZ_MAX_MATCH ? n_ - pos : LZ_MAX_MATCH;
+		if (limit < LZ_MIN_MATCH)
+			return;
+
+		// candidates are only compared up to nice bytes; the winner is extended afterwards
+		int nice = level_.nice < limit ? level_.nice : limit;
+		int chain = level_.chain;
+		for (int cand = head_[hash(pos)]; cand >= 0 && pos - cand <= level_.window && chain-- > 0; cand = prev_[cand])
+		{
+			// a longer match has to agree at the byte just past the best one so far
+			if (in_[cand + length] != in_[pos + length])
+				continue;
+			int len = matchLength(in_ + cand, in_ + pos, nice);
+			if (len > length)
+			{
+				length = len;
+				distance = pos - cand;
+				if (len == nice)
+					break;
+			}
+		}
+		if (length == nice && nice < limit)
+			length += matchLength(in_ + pos - distance + nice, in_ + pos + nice, limit - nice);
+
+		if (length < LZ_MIN_MATCH || (length == LZ_MIN_MATCH && distance > TOO_FAR))
+			length = 0;
+	}
+
+	bool lazy(int length) const
+	{
+		return length < level_.lazy;
+	}
+};
+
+/* Appends the symbols and extra bits of one match */
+void emitMatch(int length, int distance, vector<unsigned short> &litlens, vector<unsigned short> &distances, BitWriter &extras)
+{
+	int extrabits;
+	unsigned int extra;
+	litlens.push_back((unsigned short)(LZ_LENGTH_BASE + bucketOf(length - LZ_MIN_MATCH, extrabits, extra)));
+	if (extrabits > 0)
+		extras.writebits(extrabits, int(extra));
+	distances.push_back((unsigned short)bucketOf(distance - 1, extrabits, extra));
+	if (extrabits > 0)
+		extras.writebits(extrabits, int(extra));
+}
+
+void lzEncode(const unsigned char *in, int n, int level, vector<unsigned short> &litlens,
+	vector<unsigned short> &distances, BitWriter &extras)
+{
+	if (level < LZ_MIN_LEVEL)
+		level = LZ_MIN_LEVEL;
+	else if (level > LZ_MAX_LEVEL)
+		level = LZ_MAX_LEVEL;
+	MatchFinder finder(in, n, level);
+
+	int i = 0;
+	while (i < n)
+	{
+		int length, distance;
+		finder.find(i, length, distance);
+		finder.insert(i);
+
+		// lazy matching: if the next position has a longer match, this byte goes out as a literal
+		while (length > 0 && finder.lazy(length))
+		{
+			int nextlength, nextdistance;
+			finder.find(i + 1, nextlength, nextdistance);
+			if (nextlength <= length)
+				break;
+			litlens.push_back(in[i]);
+			i++;
+			finder.insert(i);
+			length = nextlength;
+			distance = nextdistance;
+		}
+
+		if (length > 0)
+		{
+			emitMatch(length, distance, litlens, distances, extras);
+			for (int k = 1; k < length; k++)
+				finder.insert(i + k);
+			i += length;
+		}
+		else
+			litlens.push_back(in[i++]);
+	}
+}
+
+bool lzDecode(const unsigned short *litlens, size_t nlitlens, const unsigned short *distances,
+	size_t ndistances, BitReader &extras, int maxlength, vector<unsigned char> &out)
+{
+	out.clear();
+	size_t d = 0;
+	for (size_t i = 0; i < nlitlens; i++)
+	{
+		int s = litlens[i];
+		if (s < 256)
+		{
+			if ((int)out.size() >= maxlength)
+				return false;
+			out.push_back((unsigned char)s);
+			continue;
+		}
+
+		int lengthbucket = s - LZ_LENGTH_BASE;
+		if (lengthbucket < 0 || lengthbucket >= LZ_LENGTH_CODES || d == ndistances || distances[d] >= LZ_DISTANCE_CODES)
+			return false;
+
+		int extrabits, extra;
+		size_t length = bucketBase(lengthbucket, extrabits) + LZ_MIN_MATCH;
+		if (extrabits > 0)
+		{
+			if (!extras.readbits(extrabits, extra))
+				return false;
+			length += extra;
+		}
+		size_t distance = bucketBase(distances[d++], extrabits) + 1;
+		if (extrabits > 0)
+		{
+			if (!extras.readbits(extrabits, extra))
+				return false;
+			distance += extra;
+		}
+		if (distance > out.size() || out.size() + length > size_t(maxlength))
+			return false;
+
+		// copies may overlap their own output, which repeats the last distance bytes
+		size_t to = out.size(), from = to - distance;
+		out.resize(to + length);
+		unsigned char *p = &out[0];
+		if (distance >= length)
+			memcpy(p + to, p + from, length);
+		else
+			for (size_t k = 0; k < length; k++)
+				p[to + k] = p[from + k];
+	}
+	return d == ndistances;
+}
+
+size_t lzMatchCount(const unsigned short *litlens, size_t count)
+{
+	size_t matches = 0;
+	for (size_t i = 0; i < count; i++)
+		if (litlens[i] >= LZ_LENGTH_BASE)
+			matches++;
+	return matches;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef _LZ77_H
+#define _LZ77_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: LZ77 front end for the Huffman coder. A block is parsed into
+	literal bytes and matches, each match copying length bytes from distance
+	bytes back, so a repeated phrase costs one match instead of a code per
+	byte. Matches are found with hash chains over the earlier bytes of the
+	block; the level sets how many candidates are tried and how far back.
+
+	The parse becomes two symbol streams and a stream of raw bits, each
+	Huffman stream with its own tree:
+		literal/length symbols
+			0..255			a literal byte
+			LZ_LENGTH_BASE + bucket		a match, whose length is in bucket
+		distance symbols	one bucket per match
+		extra bits			per match, the offset of its length within the
+							length bucket, then of its distance within the
+							distance bucket
+
+	Lengths (less LZ_MIN_MATCH) and distances (less 1) are bucketed the same
+	way: values below 4 have a bucket each, and every octave above that is
+	split into two buckets, with the position inside the bucket sent as
+	extra bits.
+*/
+
+#include <vector>
+#include <cstddef>
+
+class BitWriter;
+class BitReader;
+
+// first literal/length symbol that stands for a match; PSEUDO_EOF sits just below
+const int LZ_LENGTH_BASE = 258;
+
+const int LZ_MIN_MATCH = 3;
+const int LZ_MAX_MATCH = LZ_MIN_MATCH + 65535;
+
+// furthest a match can reach back; the distance buckets cover this far
+const int LZ_WINDOW = 1 << 20;
+
+// buckets for match lengths and distances
+const int LZ_LENGTH_CODES = 32;
+const int LZ_DISTANCE_CODES = 40;
+
+const int LZ_MIN_LEVEL = 1;
+const int LZ_MAX_LEVEL = 9;
+const int LZ_DEFAULT_LEVEL = 6;
+
+/*	Parses in[0..n) at level (LZ_MIN_LEVEL..LZ_MAX_LEVEL), appending to
+	litlens, distances and extras. */
+void lzEncode(const unsigned char *in, int n, int level, std::vector<unsigned short> &litlens,
+	std::vector<unsigned short> &distances, BitWriter &extras);
+
+/*	Undoes lzEncode into out. Returns false if the symbols are malformed,
+	refer back past the start of the block, or would expand past maxlength
+	bytes. */
+bool lzDecode(const unsigned short *litlens, size_t nlitlens, const unsigned short *distances,
+	size_t ndistances, BitReader &extras, int maxlength, std::vector<unsigned char> &out);
+
+/* Number of match symbols among litlens */
+size_t lzMatchCount(const unsigned short *litlens, size_t count);
+
+#endif
@@ -11,16 +11,30 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
 #include <boost/program_options.hpp>
 #include "prompt.h"
 #include "hufftree.h"
+#include "huffformat.h"
+#include "huffarchive.h"
+#include "filters.h"
+#include "lz77.h"
+#include "huffdaemon.h"
+#include "cpufeatures.h"
 
 using namespace std;
 namespace po = boost::program_options;
 
 int main(int argc, char **argv)
 {	
-	string infile, outfile;
+	string infile, outfile, archive, serve, connect, find;
+	bool decompress = false, verify = false, deep = false;
+	bool list = false, extract = false, sharedtable = false;
+	vector<string> members, training;
+	bool stats = false;
+	HuffOptions options;
 
 	// define command-line options
 	po::options_description desc("Allowed options");
@@ -28,6 +42,36 @@ int main(int argc, char **argv)
 		("h", "produce help message")
 		("i", po::value<string>(), "input file path")
 		("o", po::value<string>(), "output file path")
+		("u", "decompress the input file instead of compressing it")
+		("p", "overlap reading, coding and writing on separate threads")
+		("parallel", "compress or decompress an original-format file on several threads")
+		("threads", po::value<int>(), "threads for --parallel (default: one per core)")
+		("bwt", "block-sort (BWT, move-to-front, run-length) before coding")
+		("block-size", po::value<int>(), "bytes per block for the block format")
+		("delta", "delta-code fixed-width little-endian integers before coding")
+		("shuffle", "group the bytes of fixed-width elements by position before coding")
+		("width", po::value<int>(), "element width in bytes for --delta/--shuffle (2, 4 or 8)")
+		("sample", "compress in one pass, building codes from a sample of the input")
+		("sample-kb", po::value<int>(), "KB sampled from the start of the input for --sample")
+		("checksum", "store a length and CRC-32C with every block")
+		("share-tables", "reuse cached code tables across blocks with similar statistics")
+		("lengths", "store original lengths so decoding can size its output up front")
+		("lz", po::value<int>()->implicit_value(LZ_DEFAULT_LEVEL), 
+			"replace repeated strings with LZ77 matches, at effort 1-9 (default 6)")
+		("verify", "check the input file for damage instead of decompressing it")
+		("deep", "with --verify, also decode every block")
+		("archive", po::value<string>(), "archive to create from --add, or to --list or --extract")
+		("add", po::value<vector<string> >()->multitoken(), "files to pack into --archive")
+		("shared-table", "code every file added to --archive with one shared table")
+		("list", "list the members of --archive")
+		("extract", po::value<vector<string> >()->multitoken()->zero_tokens(), 
+			"members of --archive to extract (to --o), or all of them (into directory --o)")
+		("find", po::value<string>(), "print the offset of every occurrence of this string in the compressed --i")
+		("cpu", "show the instruction set extensions the kernels will use on this host")
+		("serve", po::value<string>(), "run as a compression service on this Unix socket")
+		("train", po::value<vector<string> >()->multitoken(), "files to compress once to warm --serve's tables")
+		("connect", po::value<string>(), "compress (or with --u decompress) --i into --o through the service on this socket")
+		("stats", "with --connect, print the service's counters")
 	;
 
 	// parse the command-line into a map
@@ -40,10 +84,57 @@ int main(int argc, char **argv)
 			cout << desc << endl;
 			return 1;
 		}
+		if (vm.count("cpu"))
+		{
+			cout << cpuFeatures().describe() << endl;
+			return 0;
+		}
 		if (vm.count("i"))
 			infile = vm["i"].as<string>();
 		if (vm.count("o"))
 			outfile = vm["o"].as<string>();
+		decompress = vm.count("u") > 0;
+		options.pipelined = vm.count("p") > 0;
+		options.parallel = vm.count("parallel") > 0;
+		if (vm.count("threads"))
+			options.threads = vm["threads"].as<int>();
+		options.blocksort = vm.count("bwt") > 0;
+		if (vm.count("block-size"))
+			options.blocksize = vm["block-size"].as<int>();
+		if (vm.count("delta"))
+			options.filters |= FILTER_DELTA;
+		if (vm.count("shuffle"))
+			options.filters |= FILTER_SHUFFLE;
+		if (vm.count("width"))
+			options.filterwidth = vm["width"].as<int>();
+		options.sampled = vm.count("sample") > 0;
+		if (vm.count("sample-kb"))
+			options.sampleprefix = vm["sample-kb"].as<int>() * 1024LL;
+		options.checksums = vm.count("checksum") > 0;
+		options.sharedtables = vm.count("share-tables") > 0;
+		options.lengths = vm.count("lengths") > 0;
+		if (vm.count("lz"))
+			options.lzlevel = vm["lz"].as<int>();
+		verify = vm.count("verify") > 0;
+		deep = vm.count("deep") > 0;
+		if (vm.count("archive"))
+			archive = vm["archive"].as<string>();
+		if (vm.count("add"))
+			members = vm["add"].as<vector<string> >();
+		sharedtable = vm.count("shared-table") > 0;
+		list = vm.count("list") > 0;
+		extract = vm.count("extract") > 0;
+		if (extract)
+			members = vm["extract"].as<vector<string> >();
+		if (vm.count("serve"))
+			serve = vm["serve"].as<string>();
+		if (vm.count("train"))
+			training = vm["train"].as<vector<string> >();
+		if (vm.count("connect"))
+			connect = vm["connect"].as<string>();
+		stats = vm.count("stats") > 0;
+		if (vm.count("find"))
+			find = vm["find"].as<string>();
 	} 
 	catch (std::exception e) { 
 		cout << "Error in command line. See description below.\n" 
@@ -51,17 +142,127 @@ int main(int argc, char **argv)
 		return 1; 
 	}
 
+	if (!archive.empty())
+	{
+		bool ok;
+		if (list)
+		{
+			vector<ArchiveEntry> entries;
+			ok = HuffTree::listArchive(archive, entries);
+			for (size_t i = 0; i < entries.size(); i++)
+				cout << entries[i].length << "\t" << entries[i].size << "\t" << entries[i].name << endl;
+		}
+		else if (extract && members.empty())
+			ok = HuffTree::extract(archive, members, vector<string>(1, outfile.empty() ? string() : outfile + "/"));
+		else if (extract)
+			ok = HuffTree::extract(archive, members, vector<string>(members.size() == 1 ? 1 : 0, outfile));
+		else
+			ok = HuffTree::archive(members, archive, sharedtable);
+
+		if (!ok)
+			cout << "There was a problem with the archive." << endl;
+		return ok ? 0 : 1;
+	}
+
+	if (!serve.empty())
+	{
+		HuffDaemon daemon(serve, options, options.threads);
+		daemon.train(training);
+		cout << "Serving on " << serve << endl;
+		if (!daemon.run())
+		{
+			cout << "Couldn't listen on " << serve << "." << endl;
+			return 1;
+		}
+		return 0;
+	}
+
+	if (!connect.empty())
+	{
+		vector<unsigned char> payload, response;
+		int status;
+		if (!stats)
+		{
+			ifstream in(infile.c_str(), ios::binary);
+			if (!in || outfile.empty())
+			{
+				cout << "--connect needs --i and --o." << endl;
+				return 1;
+			}
+			payload.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+		}
+		int op = stats ? HD_STATS : decompress ? HD_DECOMPRESS : HD_COMPRESS;
+		if (!daemonRequest(connect, op, payload, status, response))
+		{
+			cout << "Couldn't reach the service on " << connect << "." << endl;
+			return 1;
+		}
+		if (status != HD_OK)
+		{
+			cout << string(response.begin(), response.end()) << endl;
+			return 1;
+		}
+		if (stats)
+		{
+			cout << string(response.begin(), response.end());
+			return 0;
+		}
+		ofstream out(outfile.c_str(), ios::binary);
+		if (!response.empty())
+			out.write((const char*)&response[0], response.size());
+		return out ? 0 : 1;
+	}
+
 	if (infile.empty())
-		infile = PromptString("Enter path of file to be compressed: ");
+		infile = PromptString(decompress || verify || !find.empty() ? 
+			"Enter path of file to be decompressed: " : 
+			"Enter path of file to be compressed: ");
+
+	if (!find.empty())
+	{
+		vector<unsigned long long> offsets;
+		bool ok = HuffTree::search(infile, find, offsets);
+		for (size_t i = 0; i < offsets.size(); i++)
+			cout << offsets[i] << endl;
+		if (!ok)
+			cout << "There was a problem reading the input file." << endl;
+		return ok ? (offsets.empty() ? 1 : 0) : 2;
+	}
+
+	if (verify)
+	{
+		VerifyReport report;
+		bool ok = HuffTree::verify(infile, deep, report);
+		cout << report.blocks << " blocks checked";
+		if (!report.checksummed)
+			cout << " (no checksums, decoded)";
+		cout << endl;
+		for (size_t i = 0; i < report.badblocks.size(); i++)
+			cout << "block " << report.badblocks[i] << " is damaged" << endl;
+		if (!report.intact)
+			cout << "file is truncated or its framing is damaged" << endl;
+		cout << (ok ? "OK" : "FAILED") << endl;
+		return ok ? 0 : 1;
+	}
 	
-	if (outfile.empty())
+	if (outfile.empty() && decompress)
+	{	// use same name as infile, replace extension with _unhuffed.txt
+		outfile = infile;
+		auto dot = outfile.find_last_of('.');
+		outfile.replace(dot, infile.length() - 1, "_unhuffed.txt");
+	}
+	else if (outfile.empty())
 	{	// use same name as infile, replace extension with .hf
 		outfile = infile;
 		auto dot = outfile.find_last_of('.');
 		outfile.replace(dot, infile.length() - 1, ".hf");
 	}
 
-	if (!HuffTree::huff(infile, outfile))
+	bool ok = decompress ? 
+		HuffTree::unhuff(infile, outfile, options) : 
+		HuffTree::huff(infile, outfile, options);
+
+	if (!ok)
 	{
 		cout << "There was a problem reading the input file.";
 		return 1;
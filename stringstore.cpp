@@ -0,0 +1,125 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of StringStore declared in stringstore.h.
+*/
+
+#include "stringstore.h"
+#include <algorithm>
+#include "bytecounts.h"
+
+using namespace std;
+
+// symbols decoded per call while reading a record
+const size_t RECORD_CHUNK_SIZE = 256;
+
+StringStore::StringStore()
+	: codes_(NULL), encoder_(NULL), decoder_(NULL), rawbytes_(0)
+{
+}
+
+StringStore::~StringStore()
+{
+	delete decoder_;
+	delete encoder_;
+	delete codes_;
+}
+
+bool StringStore::train(const vector<string> &records)
+{
+	if (trained())
+		return false;
+
+	long long counts[256] = { 0 };
+	for (size_t i = 0; i < records.size(); i++)
+		countBytes((const unsigned char*)records[i].data(), records[i].size(), counts);
+
+	// every byte has a code within the kernels' limit, so the encoder always exists
+	codes_ = HuffTree::recordCodes(counts, (long long)records.size(), STORE_MAX_CODE);
+	encoder_ = HuffEncoder<unsigned char>::create(*codes_);
+	decoder_ = HuffDecoder<unsigned char>::create(*codes_);
+	return true;
+}
+
+size_t StringStore::append(const vector<string> &records)
+{
+	if (!trained())
+		train(records);
+
+	size_t first = offsets_.size();
+	anchors_.reserve((first + records.size()) / STORE_GROUP + 1);
+	offsets_.reserve(first + records.size());
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		unsigned long long pos = bits_.bitcount();
+		if (offsets_.size() % STORE_GROUP == 0)
+			anchors_.push_back(pos);
+		unsigned long long offset = pos - anchors_.back();
+		offsets_.push_back(offset < STORE_FAR ? (unsigned short)offset : STORE_FAR);
+		if (i == 0 && offsets_.back() == STORE_FAR)
+			starts_.push_back(make_pair(offsets_.size() - 1, pos));
+
+		encoder_->encode((const unsigned char*)records[i].data(), records[i].size(), bits_);
+		encoder_->encodeEOF(bits_);
+		rawbytes_ += records[i].size();
+	}
+
+	// get() only reads whole bytes, so the last record's bits can't stay in the accumulator
+	bits_.flushbits();
+	return first;
+}
+
+void StringStore::get(size_t i, string &out) const
+{
+	// walk back to a record whose offset fits, but not past the start of i's append; the
+	// group's first record always has offset 0
+	vector<pair<size_t, unsigned long long> >::const_iterator append =
+		upper_bound(starts_.begin(), starts_.end(), make_pair(i, ~0ull));
+	size_t floor = append == starts_.begin() ? 0 : (append - 1)->first;
+	size_t from = i;
+	while (from > floor && offsets_[from] == STORE_FAR)
+		from--;
+	unsigned long long pos = offsets_[from] == STORE_FAR ? (append - 1)->second :
+		anchors_[i / STORE_GROUP] + offsets_[from];
+
+	const vector<unsigned char> &bytes = bits_.bytes();
+	size_t start = size_t(pos >> 3);
+	BitReader in(&bytes[0] + start, bytes.size() - start);
+	in.refill();
+	in.consume(int(pos & 7));
+
+	// records from `from` up to i are decoded, and all but the last thrown away
+	unsigned char chunk[RECORD_CHUNK_SIZE];
+	for (; from <= i; from++)
+	{
+		out.clear();
+		DecodeStatus status;
+		do
+		{
+			size_t count;
+			status = decoder_->decode(in, chunk, RECORD_CHUNK_SIZE, count);
+			out.append((const char*)chunk, count);
+		} while (status == DECODE_FULL);
+	}
+}
+
+string StringStore::get(size_t i) const
+{
+	string out;
+	get(i, out);
+	return out;
+}
+
+size_t StringStore::memoryUsage() const
+{
+	return bits_.bytes().capacity() + anchors_.capacity() * sizeof(anchors_[0]) +
+		offsets_.capacity() * sizeof(offsets_[0]) + starts_.capacity() * sizeof(starts_[0]);
+}
+
+void StringStore::shrink()
+{
+	bits_.bytes().shrink_to_fit();
+	anchors_.shrink_to_fit();
+	offsets_.shrink_to_fit();
+	starts_.shrink_to_fit();
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef _STRINGSTORE_H
+#define _STRINGSTORE_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: An append-only collection of short strings (keys, URLs, log
+	lines) kept Huffman coded in memory, with any single record decodable
+	on its own.
+
+	One code table is trained on the collection. Each record is stored as
+	its bytes' codes followed by PSEUDO_EOF, packed bit to bit into a single
+	buffer. The index is two arrays:
+		anchors		the 64-bit bit offset of every STORE_GROUP'th record
+		offsets		16 bits per record, its offset from its group's anchor
+	so the index costs 2.5 bytes per record. A record more than STORE_FAR
+	bits past its anchor is marked STORE_FAR instead. get() then starts at
+	the nearest earlier record whose offset fits, and decodes forward past
+	the records in between.
+
+	Each append pads its last byte out with zeros, and decoding forward
+	must not run into that padding. So when the first record of an append
+	is STORE_FAR, its exact offset is kept in a third, sparse list, and a
+	walk back stops there.
+
+	get() is const and may run on several threads at once, as long as no
+	append is running.
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "hufftree.h"
+#include "bitbuffer.h"
+#include "huffkernels.h"
+
+// records per anchor in the offset index
+const size_t STORE_GROUP = 16;
+
+// longest code the table may have; the encode kernels take up to 32 bits
+const int STORE_MAX_CODE = 32;
+
+// offset marking a record too far from its anchor to index directly
+const unsigned short STORE_FAR = 0xFFFF;
+
+class StringStore
+{
+private:
+	HuffTree::CodeMap *codes_;
+	HuffEncoder<unsigned char> *encoder_;
+	HuffDecoder<unsigned char> *decoder_;
+	BitWriter bits_;							// every record's codes, each ending in PSEUDO_EOF
+	std::vector<unsigned long long> anchors_;	// bit offset of records 0, STORE_GROUP, 2 * STORE_GROUP...
+	std::vector<unsigned short> offsets_;		// bit offset of each record from its anchor, or STORE_FAR
+	std::vector<std::pair<size_t, unsigned long long> > starts_;	// appends' STORE_FAR first records, by bit offset
+	unsigned long long rawbytes_;
+
+public:
+	StringStore();
+	~StringStore();
+
+	/* Builds the code table from a sample of the records. Only allowed before the first append */
+	bool train(const std::vector<std::string> &records);
+
+	bool trained() const { return codes_ != NULL; }
+
+	/*	Appends records, training on them first if there is no table yet.
+		Returns the index of the first one. */
+	size_t append(const std::vector<std::string> &records);
+
+	/* Decodes record i (i < size()) into out */
+	void get(size_t i, std::string &out) const;
+	std::string get(size_t i) const;
+
+	size_t size() const { return offsets_.size(); }
+
+	// total length of the records as given to append
+	unsigned long long rawBytes() const { return rawbytes_; }
+
+	// bytes held for the codes and the index
+	size_t memoryUsage() const;
+
+	/* Gives back the spare capacity left by appends; call after the last one */
+	void shrink();
+
+private:
+	// not copyable
+	StringStore(const StringStore&);
+	StringStore& operator=(const StringStore&);
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Implementation of CodeTable and TableCache declared in
+	tablecache.h.
+*/
+
+#include "tablecache.h"
+
+using namespace std;
+
+// tables kept by the shared cache; each one is a few tens of KB
+const size_t SHARED_CACHE_TABLES = 256;
+
+CodeTable::CodeTable(HuffPtr tree, HuffTree::CodeMap *codes)
+	: tree(tree), codes(codes)
+{
+	encoder = HuffEncoder<unsigned short>::create(*codes);
+	decoder = HuffDecoder<unsigned short>::create(*codes);
+}
+
+CodeTable::~CodeTable()
+{
+	delete decoder;
+	delete encoder;
+	delete codes;
+	delete tree;
+}
+
+TableCache::TableCache(size_t capacity)
+	: capacity_(capacity), hits_(0), misses_(0)
+{
+}
+
+CodeTablePtr TableCache::find(const string &key)
+{
+	lock_guard<mutex> guard(lock_);
+	auto it = index_.find(key);
+	if (it == index_.end())
+	{
+		misses_++;
+		return CodeTablePtr();
+	}
+
+	hits_++;
+	entries_.splice(entries_.begin(), entries_, it->second);
+	return it->second->second;
+}
+
+void TableCache::insert(const string &key, const CodeTablePtr &table)
+{
+	lock_guard<mutex> guard(lock_);
+	auto it = index_.find(key);
+	if (it != index_.end())
+	{	// another thread built the same table first
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return;
+	}
+
+	entries_.push_front(Entry(key, table));
+	index_[key] = entries_.begin();
+	if (entries_.size() > capacity_)
+	{
+		index_.erase(entries_.back().first);
+		entries_.pop_back();
+	}
+}
+
+long long TableCache::hits()
+{
+	lock_guard<mutex> guard(lock_);
+	return hits_;
+}
+
+long long TableCache::misses()
+{
+	lock_guard<mutex> guard(lock_);
+	return misses_;
+}
+
+TableCache& TableCache::shared()
+{
+	static TableCache cache(SHARED_CACHE_TABLES);
+	return cache;
+}
+
+TableWindow::TableWindow(size_t capacity)
+	: capacity_(capacity)
+{
+}
+
+void TableWindow::add(unsigned int block, const string &key, const CodeTablePtr &table)
+{
+	entries_.push_back(Entry(block, make_pair(key, table)));
+	if (entries_.size() > capacity_)
+		entries_.pop_front();
+}
+
+bool TableWindow::find(const string &key, unsigned int &block, CodeTablePtr &table) const
+{
+	for (auto it = entries_.rbegin(); it != entries_.rend(); ++it)
+		if (it->second.first == key)
+		{
+			block = it->first;
+			table = it->second.second;
+			return true;
+		}
+	return false;
+}
+
+CodeTablePtr TableWindow::table(unsigned int block) const
+{
+	for (auto it = entries_.rbegin(); it != entries_.rend(); ++it)
+		if (it->first == block)
+			return it->second.second;
+	return CodeTablePtr();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#ifndef _TABLECACHE_H
+#define _TABLECACHE_H
+
+/*
+	Created on 10/19/2026
+
+	Summary: A bounded, thread-safe cache of ready-to-use code tables. Building
+	a table means building a tree, walking it for the code map and filling the
+	encode and decode tables, which costs far more than coding a small block.
+	Blocks from the same source usually have the same statistics, so tables
+	are stored under a content key and handed out again when an equal key
+	comes up.
+
+	Keys are byte strings chosen by the caller (see HuffTables.cpp): either a
+	quantized histogram, or the bits of a tree header. Tables are immutable
+	once built and shared through CodeTablePtr, so an evicted table stays
+	alive for as long as a caller is still using it.
+*/
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "hufftree.h"
+#include "huffkernels.h"
+
+// Everything needed to code with one tree over the wide symbol alphabet
+class CodeTable
+{
+public:
+	HuffPtr tree;
+	HuffTree::CodeMap *codes;
+	HuffEncoder<unsigned short> *encoder;
+	HuffDecoder<unsigned short> *decoder;
+
+	CodeTable(HuffPtr tree, HuffTree::CodeMap *codes);
+	~CodeTable();
+
+private:
+	// not copyable
+	CodeTable(const CodeTable&);
+	CodeTable& operator=(const CodeTable&);
+};
+
+typedef std::shared_ptr<const CodeTable> CodeTablePtr;
+
+// Least-recently-used map from content keys to tables
+class TableCache
+{
+private:
+	typedef std::pair<std::string, CodeTablePtr> Entry;
+
+	std::list<Entry> entries_;	// most recently used first
+	std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+	size_t capacity_;
+	long long hits_, misses_;
+	std::mutex lock_;
+
+public:
+	explicit TableCache(size_t capacity);
+
+	/* Returns the table stored under key, or an empty pointer */
+	CodeTablePtr find(const std::string &key);
+
+	/* Stores table under key, evicting the least recently used table if full */
+	void insert(const std::string &key, const CodeTablePtr &table);
+
+	long long hits();
+	long long misses();
+
+	/* The cache shared by every coder in the process */
+	static TableCache& shared();
+
+private:
+	// not copyable
+	TableCache(const TableCache&);
+	TableCache& operator=(const TableCache&);
+};
+
+// Tables defined by the most recent blocks of one file (HF_TABLEREF)
+class TableWindow
+{
+private:
+	typedef std::pair<unsigned int, std::pair<std::string, CodeTablePtr> > Entry;
+
+	std::deque<Entry> entries_;	// oldest first
+	size_t capacity_;
+
+public:
+	explicit TableWindow(size_t capacity);
+
+	/* Records that block defined table, dropping the oldest entry if full */
+	void add(unsigned int block, const std::string &key, const CodeTablePtr &table);
+
+	/* Finds the latest block whose table has key */
+	bool find(const std::string &key, unsigned int &block, CodeTablePtr &table) const;
+
+	/* Returns the table block defined, or an empty pointer if it has left the window */
+	CodeTablePtr table(unsigned int block) const;
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Checks that block format files whose record lengths have been
+	damaged are refused without sizing a buffer from the damaged length.
+
+	Build with the library sources (everything but main_huff.cpp), e.g.
+		g++ -std=c++11 -pthread -I.. blockrecord_test.cpp ../HuffBlocks.cpp ...
+	Exits 0 if every check passed.
+*/
+
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "hufftree.h"
+#include "huffformat.h"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+// bytes before the first record of a file with only HF_CHECKSUM set
+const size_t CHECKSUM_HEADER_BYTES = 10;
+
+/* Stores value big-endian at data[at] */
+void putU32(vector<unsigned char> &data, size_t at, unsigned int value)
+{
+	for (int k = 0; k < 4; k++)
+		data[at + k] = (unsigned char)(value >> (24 - 8 * k));
+}
+
+/* The status of the first record of a file */
+RecordStatus firstRecord(const vector<unsigned char> &file)
+{
+	istringstream in(string(file.begin(), file.end()));
+	HuffFileInfo info;
+	BlockRecord record;
+	if (!readFormatHeader(in, info))
+		return RECORD_BAD;
+	return readBlockRecord(in, info, record);
+}
+
+/* Reports a failed check. Returns 1 if it failed */
+int check(bool ok, const string &what)
+{
+	if (!ok)
+		cout << "failed: " << what << endl;
+	return ok ? 0 : 1;
+}
+
+int main()
+{
+#ifndef _WIN32
+	// without a limit, an overcommitting host hands out a damaged length's 4 GB and only the read fails
+	rlimit limit = { 1ul << 30, 1ul << 30 };
+	setrlimit(RLIMIT_AS, &limit);
+#endif
+
+	string text;
+	for (int i = 0; i < 4000; i++)
+		text += "line " + to_string(i * 7919 % 1000) + " of the sample\n";
+	vector<unsigned char> src(text.begin(), text.end()), file, out;
+
+	HuffOptions options;
+	options.checksums = true;
+	options.blocksize = 1 << 14;
+	int failed = 0;
+	failed += check(HuffTree::huff(src, file, options), "compressing the sample");
+	failed += check(firstRecord(file) == RECORD_OK, "reading an intact record");
+	failed += check(HuffTree::unhuff(file, out) && out == src, "decoding an intact file");
+
+	// lengths past anything the block size codes to, and past the end of the file
+	const unsigned int lengths[] = { 0xFFFFFFF0u, 0x80000000u, unsigned(HF_PAYLOAD_PER_BYTE) * (1 << 14),
+		unsigned(file.size()) };
+	for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+	{
+		vector<unsigned char> damaged(file);
+		putU32(damaged, CHECKSUM_HEADER_BYTES, lengths[i]);
+		string what = "record length " + to_string(lengths[i]);
+		try
+		{
+			failed += check(firstRecord(damaged) == RECORD_BAD, what + " is refused");
+			failed += check(!HuffTree::unhuff(damaged, out), what + " fails to decode");
+		}
+		catch (const bad_alloc&)
+		{
+			failed += check(false, what + " sized a buffer from the damaged length");
+		}
+	}
+
+	cout << failed << " checks failed" << endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/*
+	Created on 10/19/2026
+
+	Summary: Checks that StringStore gives back every record it was given,
+	when the records arrive over several appends of different sizes and are
+	long enough that many of them are STORE_FAR from their anchor.
+
+	Build with the library sources (everything but main_huff.cpp), e.g.
+		g++ -std=c++11 -pthread -I.. stringstore_test.cpp ../stringstore.cpp ...
+	Exits 0 if every record matched.
+*/
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "stringstore.h"
+
+using namespace std;
+
+/*	A record of maxlength / 2 to maxlength bytes drawn from a skewed
+	alphabet, so codes have different lengths */
+string makeRecord(mt19937 &random, size_t maxlength)
+{
+	static const string alphabet = "eeeeeeettttaaoinshrdlu ,.0123456789ABCXYZ\n";
+	string record(maxlength / 2 + random() % (maxlength / 2 + 1), ' ');
+	for (size_t i = 0; i < record.size(); i++)
+		record[i] = alphabet[random() % alphabet.size()];
+	return record;
+}
+
+/* Compares every record in store with expected, reporting each mismatch. Returns the number wrong */
+size_t checkAll(const StringStore &store, const vector<string> &expected)
+{
+	size_t wrong = 0;
+	if (store.size() != expected.size())
+	{
+		cout << "size " << store.size() << ", expected " << expected.size() << endl;
+		return expected.size();
+	}
+	for (size_t i = 0; i < expected.size(); i++)
+		if (store.get(i) != expected[i])
+		{
+			cout << "record " << i << " came back wrong" << endl;
+			wrong++;
+		}
+	return wrong;
+}
+
+int main()
+{
+	mt19937 random(2026);
+	StringStore store;
+	vector<string> expected;
+	size_t wrong = 0;
+
+	// Appends that start at, just after, and well inside a group. A few long
+	// records take a group past STORE_FAR bits from its anchor, so the
+	// appends after them start with STORE_FAR records
+	const size_t batches[][2] = { { 5, 40 }, { 1, 40 }, { 16, 40 }, { 3, 4000 }, { 2, 4000 }, { 1, 40 },
+		{ 1, 40 }, { 4, 40 }, { 7, 4000 }, { 3, 40 }, { 40, 40 }, { 1, 4000 }, { 1, 4000 }, { 2, 4000 },
+		{ 1, 4000 }, { 1, 40 }, { 2, 40 }, { 100, 40 }, { 12, 4000 }, { 3, 40 }, { 64, 40 }, { 139, 40 } };
+	for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+	{
+		vector<string> batch;
+		for (size_t i = 0; i < batches[b][0]; i++)
+			batch.push_back(makeRecord(random, batches[b][1]));
+
+		size_t first = store.append(batch);
+		if (first != expected.size())
+		{
+			cout << "append returned " << first << ", expected " << expected.size() << endl;
+			wrong++;
+		}
+		expected.insert(expected.end(), batch.begin(), batch.end());
+
+		// earlier records must stay readable as later appends go in
+		wrong += checkAll(store, expected);
+	}
+
+	store.shrink();
+	wrong += checkAll(store, expected);
+
+	cout << expected.size() << " records, " << wrong << " wrong" << endl;
+	return wrong == 0 ? 0 : 1;
+}